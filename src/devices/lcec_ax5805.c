@@ -170,9 +170,8 @@ static int lcec_ax5805_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_ax5805_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_ax5805_data_t *hal_data = (lcec_ax5805_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
 
   copy_fsoe_data(slave, hal_data->fsoe_slave_cmd_os, hal_data->fsoe_master_cmd_os);
 
@@ -165,7 +165,7 @@ lcec_class_aout_channel_t *lcec_aout_register_channel(
 /// Call this once per channel registered, from inside of your device's
 /// read function.  Use `lcec_aout_write_all` to read all pins.
 void lcec_aout_write(struct lcec_slave *slave, lcec_class_aout_channel_t *data) {
-  uint8_t *pd = slave->master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int max_value = data->options->max_value;
   double tmpval, tmpdc, raw_val;
   
@@ -191,8 +191,7 @@ void lcec_class_ax5_check_scales(lcec_class_ax5_chan_t *chan) {
 }
 
 void lcec_class_ax5_read(struct lcec_slave *slave, lcec_class_ax5_chan_t *chan) {
-  lcec_master_t *master = slave->master;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint32_t pos_cnt;
 
   // wait for slave to be operational
@@ -242,8 +241,7 @@ void lcec_class_ax5_read(struct lcec_slave *slave, lcec_class_ax5_chan_t *chan)
 }
 
 void lcec_class_ax5_write(struct lcec_slave *slave, lcec_class_ax5_chan_t *chan) {
-  lcec_master_t *master = slave->master;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint16_t ctrl;
   double velo_cmd_raw;
 
@@ -91,8 +91,7 @@ lcec_class_din_channel_t *lcec_din_register_channel(
 /// Call this once per pin registered, from inside of your device's
 /// read function.  See `lcec_din_read_all` for an alternative approach.
 void lcec_din_read(struct lcec_slave *slave, lcec_class_din_channel_t *data) {
-  lcec_master_t *master = slave->master;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   hal_bit_t s;
 
   s = EC_READ_BIT(&pd[data->pdo_os], data->pdo_bp);
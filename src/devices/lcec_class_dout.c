@@ -100,8 +100,7 @@ lcec_class_dout_channel_t *lcec_dout_register_channel(
 // Call this once per channel registered, from inside of your device's
 // write function.
 void lcec_dout_write(struct lcec_slave *slave, lcec_class_dout_channel_t *data) {
-  lcec_master_t *master = slave->master;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   hal_bit_t s;
 
   s = *(data->out);
@@ -132,6 +132,10 @@ typedef struct {
   unsigned int divalue_pdo_os;
   unsigned int torque_pdo_os;
 
+  lcec_interp_t cmdvalue_interp;
+  lcec_fb_avg_t currpos_avg;
+  lcec_fb_avg_t currvel_avg;
+
 
   hal_bit_t last_switch_on;
   hal_bit_t internal_fault;
@@ -248,7 +252,7 @@ static int lcec_deasda_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
   uint32_t tu;
   int8_t ti;
   drive_operationmodes_t const *driveopmode;
-  static uint16_t operationmode;
+  uint16_t operationmode;
 
   uint64_t flags;
   flags = slave->flags;
@@ -298,7 +302,7 @@ static int lcec_deasda_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
   }
 
   // set interpolation time period
-  tu = master->app_time_period;
+  tu = master->bus_period;
   ti = -9;
 
   while ((tu % 10) == 0 || tu > 255) { tu /=  10; ti++; }
@@ -350,6 +354,11 @@ static int lcec_deasda_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 
   }
 
+  // interpolate the command value and average feedback if the bus runs faster than the servo thread
+  lcec_interp_init(slave, &hal_data->cmdvalue_interp, &hal_data->cmdvalue_pdo_os);
+  lcec_fb_avg_init(slave, &hal_data->currpos_avg, &hal_data->currpos_pdo_os);
+  lcec_fb_avg_init(slave, &hal_data->currvel_avg, &hal_data->currvel_pdo_os);
+
   *(hal_data->operation_mode) = operationmode;
   // export parameters
   if ((err = lcec_param_newf_list(hal_data, slave_params, LCEC_MODULE_NAME, master->name, slave->name)) != 0) return err;
@@ -402,9 +411,8 @@ void lcec_deasda_check_scales(lcec_deasda_data_t *hal_data) {
 }
 
 static void lcec_deasda_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_deasda_data_t *hal_data = (lcec_deasda_data_t *)slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint16_t status;
   uint32_t status_di;
   int32_t speed_raw;
@@ -503,9 +511,8 @@ static void lcec_deasda_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_deasda_write_csv(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_deasda_data_t *hal_data = (lcec_deasda_data_t *)slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint16_t control;
   double speed_raw;
   int switch_on_edge;
@@ -549,13 +556,12 @@ static void lcec_deasda_write_csv(struct lcec_slave *slave, long period) {
   if (speed_raw > (double)0x7fffffff) speed_raw = (double)0x7fffffff;
   if (speed_raw < (double)-0x7fffffff) speed_raw = (double)-0x7fffffff;
 
-  EC_WRITE_S32(&pd[hal_data->cmdvalue_pdo_os], (int32_t)speed_raw);
+  lcec_interp_write(&hal_data->cmdvalue_interp, pd, (int32_t)speed_raw);
 }
 
 static void lcec_deasda_write_csp(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_deasda_data_t *hal_data = (lcec_deasda_data_t *)slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint16_t control;
   int32_t pos_puu;
   int switch_on_edge;
@@ -593,7 +599,7 @@ static void lcec_deasda_write_csp(struct lcec_slave *slave, long period) {
   // See https://www.deltaww.com/en-US/FAQ/228
   // Calculation accordingly based on pprev and pos_scale (i.e. pitch of ball screw)
   pos_puu = (int32_t)(*(hal_data->cmd_value) * hal_data->pprev / hal_data->pos_scale);
-  EC_WRITE_S32(&pd[hal_data->cmdvalue_pdo_os], pos_puu);
+  lcec_interp_write(&hal_data->cmdvalue_interp, pd, pos_puu);
 }
 
 // Match the drive mode configuration in modparams and return the settings for that particular operational mode.
@@ -131,8 +131,7 @@ static int lcec_el2202_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el2202_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
 
   lcec_el2202_data_t *hal_data = (lcec_el2202_data_t *) slave->hal_data;
   lcec_el2202_chan_t *chan;
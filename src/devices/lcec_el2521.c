@@ -240,9 +240,8 @@ static void lcec_el2521_check_scale(lcec_el2521_data_t *hal_data) {
 }
 
 static void lcec_el2521_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el2521_data_t *hal_data = (lcec_el2521_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int16_t hw_count, hw_count_diff;
   uint16_t state;
   int in;
@@ -289,9 +288,8 @@ static void lcec_el2521_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_el2521_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el2521_data_t *hal_data = (lcec_el2521_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint16_t ctrl;
   int32_t freq_raw;
 
@@ -153,9 +153,8 @@ static int lcec_el2904_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el2904_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el2904_data_t *hal_data = (lcec_el2904_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
 
   copy_fsoe_data(slave, hal_data->fsoe_slave_cmd_os, hal_data->fsoe_master_cmd_os);
 
@@ -174,9 +173,8 @@ static void lcec_el2904_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_el2904_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el2904_data_t *hal_data = (lcec_el2904_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
 
   EC_WRITE_BIT(&pd[hal_data->out_0_os], hal_data->out_0_bp, *(hal_data->out_0));
   EC_WRITE_BIT(&pd[hal_data->out_1_os], hal_data->out_1_bp, *(hal_data->out_1));
@@ -129,9 +129,8 @@ static int lcec_el31x2_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el31x2_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el31x2_data_t *hal_data = (lcec_el31x2_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i;
   lcec_el31x2_chan_t *chan;
   uint8_t state;
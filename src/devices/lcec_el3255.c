@@ -200,9 +200,8 @@ static int lcec_el3255_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el3255_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el3255_data_t *hal_data = (lcec_el3255_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i;
   lcec_el3255_chan_t *chan;
   int16_t value;
@@ -182,9 +182,8 @@ static int lcec_el5032_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el5032_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el5032_data_t *hal_data = (lcec_el5032_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i;
   lcec_el5032_chan_t *chan;
   int64_t raw_count, raw_delta;
@@ -196,9 +196,8 @@ static int lcec_el5101_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el5101_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el5101_data_t *hal_data = (lcec_el5101_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint8_t raw_status;
   int16_t raw_count, raw_latch, raw_delta;
   uint16_t raw_period, raw_window;
@@ -295,9 +294,8 @@ static void lcec_el5101_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_el5101_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el5101_data_t *hal_data = (lcec_el5101_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint8_t raw_ctrl;
 
   // build control byte
@@ -235,9 +235,8 @@ static int lcec_el5151_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el5151_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el5151_data_t *hal_data = (lcec_el5151_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int32_t raw_count, raw_latch, raw_delta;
   uint32_t raw_period;
 
@@ -330,9 +329,8 @@ static void lcec_el5151_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_el5151_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el5151_data_t *hal_data = (lcec_el5151_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
 
   // set output data
   EC_WRITE_BIT(&pd[hal_data->set_count_pdo_os], hal_data->set_count_pdo_bp, *(hal_data->set_raw_count));
@@ -348,11 +348,10 @@ static int lcec_el6090_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el6090_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el6090_data_t *hal_data = (lcec_el6090_data_t *) slave->hal_data;
   lcec_el6090_chan_t *chan;
   
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i;
   uint32_t operating_time;
 
@@ -388,11 +387,10 @@ static void lcec_el6090_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_el6090_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el6090_data_t *hal_data = (lcec_el6090_data_t *) slave->hal_data;
   lcec_el6090_chan_t *chan;
 
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i;
 
   // Write Value LCD
@@ -308,9 +308,8 @@ static int lcec_el6900_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 void lcec_el6900_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el6900_data_t *hal_data = (lcec_el6900_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   lcec_el6900_fsoe_t *fsoe_data;
   int i, crc_idx;
   lcec_el6900_fsoe_io_t *io;
@@ -342,9 +341,8 @@ void lcec_el6900_read(struct lcec_slave *slave, long period) {
 }
 
 void lcec_el6900_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el6900_data_t *hal_data = (lcec_el6900_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   lcec_el6900_fsoe_io_t *io;
   int i;
 
@@ -597,9 +597,8 @@ static int lcec_el7041_init(int comp_id, struct lcec_slave *s, ec_pdo_entry_reg_
 }
 
 static void lcec_el7041_read(struct lcec_slave *s, long period) {
-  lcec_master_t *m = s->master;
   lcec_el7041_data_t *hd = (lcec_el7041_data_t *)s->hal_data;
-  uint8_t *pd = m->process_data;
+  uint8_t *pd = lcec_slave_process_data(s);
   int16_t raw_count, raw_latch, raw_delta;
 
   // wait for slave to be operational
@@ -719,9 +718,8 @@ static void lcec_el7041_read(struct lcec_slave *s, long period) {
 }
 
 static void lcec_el7041_write(struct lcec_slave *s, long period) {
-  lcec_master_t *m = s->master;
   lcec_el7041_data_t *hd = (lcec_el7041_data_t *)s->hal_data;
-  uint8_t *pd = m->process_data;
+  uint8_t *pd = lcec_slave_process_data(s);
   double tmpval, tmpdc, raw_val;
   int enable_on_edge;
 
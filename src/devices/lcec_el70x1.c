@@ -367,9 +367,8 @@ static int lcec_el70x1_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el70x1_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el70x1_data_t *hal_data = (lcec_el70x1_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
 
   *(hal_data->stm_ready_to_enable) = EC_READ_BIT(&pd[hal_data->stm_ready_to_enable_pdo_os], hal_data->stm_ready_to_enable_pdo_bp);
   *(hal_data->stm_ready) = EC_READ_BIT(&pd[hal_data->stm_ready_pdo_os], hal_data->stm_ready_pdo_bp);
@@ -385,9 +384,8 @@ static void lcec_el70x1_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_el70x1_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el70x1_data_t *hal_data = (lcec_el70x1_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   bool enabled, reduce_tourque;
 
   *(hal_data->stm_pos_cmd_raw) = (int32_t) (*(hal_data->stm_pos_cmd) * hal_data->stm_pos_scale);
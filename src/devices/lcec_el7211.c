@@ -89,6 +89,10 @@ typedef struct {
   unsigned int vel_cmd_pdo_os;
   unsigned int info1_pdo_os;
 
+  lcec_interp_t vel_cmd_interp;
+  lcec_fb_avg_t pos_fb_avg;
+  lcec_fb_avg_t vel_fb_avg;
+
   double vel_scale;
   double vel_rcpt;
 
@@ -300,6 +304,11 @@ static int lcec_el7211_export_pins(lcec_master_t *master, struct lcec_slave *sla
   LCEC_PDO_INIT(pdo_entry_regs, slave->index, slave->vid, slave->pid, 0x7010, 0x01, &hal_data->ctrl_pdo_os, NULL);
   LCEC_PDO_INIT(pdo_entry_regs, slave->index, slave->vid, slave->pid, 0x7010, 0x06, &hal_data->vel_cmd_pdo_os, NULL);
 
+  // interpolate the velocity command and average feedback if the bus runs faster than the servo thread
+  lcec_interp_init(slave, &hal_data->vel_cmd_interp, &hal_data->vel_cmd_pdo_os);
+  lcec_fb_avg_init(slave, &hal_data->pos_fb_avg, &hal_data->pos_fb_pdo_os);
+  lcec_fb_avg_init(slave, &hal_data->vel_fb_avg, &hal_data->vel_fb_pdo_os);
+
   // export pins
   if ((err = lcec_el7211_export_pins(master, slave, hal_data)) != 0) {
     return err;
@@ -339,6 +348,11 @@ static int lcec_el7201_9014_init(int comp_id, struct lcec_slave *slave, ec_pdo_e
   LCEC_PDO_INIT(pdo_entry_regs, slave->index, slave->vid, slave->pid, 0x7010, 0x06, &hal_data->vel_cmd_pdo_os, NULL);
   LCEC_PDO_INIT(pdo_entry_regs, slave->index, slave->vid, slave->pid, 0x6010, 0x12, &hal_data->info1_pdo_os, NULL);
 
+  // interpolate the velocity command and average feedback if the bus runs faster than the servo thread
+  lcec_interp_init(slave, &hal_data->vel_cmd_interp, &hal_data->vel_cmd_pdo_os);
+  lcec_fb_avg_init(slave, &hal_data->pos_fb_avg, &hal_data->pos_fb_pdo_os);
+  lcec_fb_avg_init(slave, &hal_data->vel_fb_avg, &hal_data->vel_fb_pdo_os);
+
   // export pins
   if ((err = lcec_el7211_export_pins(master, slave, hal_data)) != 0) {
     return err;
@@ -375,9 +389,8 @@ static void lcec_el7211_check_scales(lcec_el7211_data_t *hal_data) {
 }
 
 static void lcec_el7211_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el7211_data_t *hal_data = (lcec_el7211_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint16_t status;
   int32_t vel_raw;
   double vel;
@@ -441,9 +454,8 @@ static void lcec_el7211_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_el7201_9014_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el7211_data_t *hal_data = (lcec_el7211_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint16_t info1;
 
   lcec_el7211_read(slave, period);
@@ -464,9 +476,8 @@ static inline double clamp(double v, double sub, double sup) {
 }
 
 static void lcec_el7211_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el7211_data_t *hal_data = (lcec_el7211_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint16_t control;
   double velo_cmd, velo_raw, velo_maxdelta;
 
@@ -504,7 +515,7 @@ static void lcec_el7211_write(struct lcec_slave *slave, long period) {
     velo_raw = (double)-0x7fffffff;
   }
   *(hal_data->vel_cmd_out_raw) = (int32_t) velo_raw;
-  EC_WRITE_S32(&pd[hal_data->vel_cmd_pdo_os], *(hal_data->vel_cmd_out_raw));
+  lcec_interp_write(&hal_data->vel_cmd_interp, pd, *(hal_data->vel_cmd_out_raw));
 
 }
 
@@ -495,9 +495,8 @@ static int lcec_el7342_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el7342_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el7342_data_t *hal_data = (lcec_el7342_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i;
   lcec_el7342_chan_t *chan;
   int16_t raw_count, raw_latch, raw_delta;
@@ -605,9 +604,8 @@ static void lcec_el7342_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_el7342_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el7342_data_t *hal_data = (lcec_el7342_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i;
   lcec_el7342_chan_t *chan;
   double tmpval, tmpdc, raw_val;
@@ -81,9 +81,8 @@ static int lcec_el95xx_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_el95xx_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_el95xx_data_t *hal_data = (lcec_el95xx_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
 
   // wait for slave to be operational
   if (!slave->state.operational) {
@@ -271,9 +271,8 @@ static int lcec_em7004_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_
 }
 
 static void lcec_em7004_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_em7004_data_t *hal_data = (lcec_em7004_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   lcec_em7004_din_t *din;
   lcec_em7004_enc_t *enc;
   int i, s;
@@ -363,9 +362,8 @@ static void lcec_em7004_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_em7004_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_em7004_data_t *hal_data = (lcec_em7004_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   lcec_em7004_dout_t *dout;
   lcec_em7004_aout_t *aout;
   lcec_em7004_enc_t *enc;
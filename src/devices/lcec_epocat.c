@@ -139,6 +139,9 @@ typedef struct {
   hal_bit_t update_02_position;
   hal_bit_t update_03_position;
   hal_bit_t update_04_position;
+
+  uint16_t raw_counts_old[5];
+  int32_t counts[5];
 } lcec_fr4000_data_t;
 
 static const lcec_pindesc_t slave_pins[] = {
@@ -361,9 +364,6 @@ static ec_sync_info_t lcec_fr4000_syncs[] = {{0, EC_DIR_OUTPUT, 7, lcec_fr4000_p
                                              {1, EC_DIR_INPUT, 8, lcec_fr4000_pdos + 7, EC_WD_DISABLE},
                                              {0xff}};
 
-static uint16_t raw_counts_old[5];
-static int32_t counts[5];
-
 void lcec_fr4000_read(struct lcec_slave *slave, long period);
 void lcec_fr4000_write(struct lcec_slave *slave, long period);
 
@@ -415,17 +415,17 @@ int lcec_fr4000_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_reg_t *
   }
 
   // initialize variables
-  raw_counts_old[0] = 0;
-  raw_counts_old[1] = 0;
-  raw_counts_old[2] = 0;
-  raw_counts_old[3] = 0;
-  raw_counts_old[4] = 0;
-
-  counts[0] = 0;
-  counts[1] = 0;
-  counts[2] = 0;
-  counts[3] = 0;
-  counts[4] = 0;
+  hal_data->raw_counts_old[0] = 0;
+  hal_data->raw_counts_old[1] = 0;
+  hal_data->raw_counts_old[2] = 0;
+  hal_data->raw_counts_old[3] = 0;
+  hal_data->raw_counts_old[4] = 0;
+
+  hal_data->counts[0] = 0;
+  hal_data->counts[1] = 0;
+  hal_data->counts[2] = 0;
+  hal_data->counts[3] = 0;
+  hal_data->counts[4] = 0;
 
   hal_data->enc_00_scale = 1;
   hal_data->enc_01_scale = 1;
@@ -455,9 +455,8 @@ int lcec_fr4000_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_reg_t *
 }
 
 void lcec_fr4000_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_fr4000_data_t *hal_data = (lcec_fr4000_data_t *)slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
 
   uint16_t raw_counts[5];
   int32_t raw_forced_counts[5];
@@ -495,31 +494,31 @@ void lcec_fr4000_read(struct lcec_slave *slave, long period) {
     // cancel index-enable
     *(hal_data->enc_00_index_enable) = 0;
 
-    counts[0] = 0;
+    hal_data->counts[0] = 0;
   }
   if (EC_READ_BIT(&pd[hal_data->off_FLAG], 1) == 1) {
     // cancel index-enable
     *(hal_data->enc_01_index_enable) = 0;
 
-    counts[1] = 0;
+    hal_data->counts[1] = 0;
   }
   if (EC_READ_BIT(&pd[hal_data->off_FLAG], 2) == 1) {
     // cancel index-enable
     *(hal_data->enc_02_index_enable) = 0;
 
-    counts[2] = 0;
+    hal_data->counts[2] = 0;
   }
   if (EC_READ_BIT(&pd[hal_data->off_FLAG], 3) == 1) {
     // cancel index-enable
     *(hal_data->enc_03_index_enable) = 0;
 
-    counts[3] = 0;
+    hal_data->counts[3] = 0;
   }
   if (EC_READ_BIT(&pd[hal_data->off_FLAG], 4) == 1) {
     // cancel index-enable
     *(hal_data->enc_04_index_enable) = 0;
 
-    counts[4] = 0;
+    hal_data->counts[4] = 0;
   }
 
   if (hal_data->update_00_position == true) {
@@ -527,63 +526,63 @@ void lcec_fr4000_read(struct lcec_slave *slave, long period) {
 
     raw_forced_counts[0] = hal_data->set_00_position / hal_data->enc_00_scale;
 
-    counts[0] = (int32_t)raw_forced_counts[0];
+    hal_data->counts[0] = (int32_t)raw_forced_counts[0];
   }
   if (hal_data->update_01_position == true) {
     hal_data->update_01_position = false;
 
     raw_forced_counts[1] = hal_data->set_01_position / hal_data->enc_01_scale;
 
-    counts[1] = (int32_t)raw_forced_counts[1];
+    hal_data->counts[1] = (int32_t)raw_forced_counts[1];
   }
   if (hal_data->update_02_position == true) {
     hal_data->update_02_position = false;
 
     raw_forced_counts[2] = hal_data->set_02_position / hal_data->enc_02_scale;
 
-    counts[2] = (int32_t)raw_forced_counts[2];
+    hal_data->counts[2] = (int32_t)raw_forced_counts[2];
   }
   if (hal_data->update_03_position == true) {
     hal_data->update_03_position = false;
 
     raw_forced_counts[3] = hal_data->set_03_position / hal_data->enc_03_scale;
 
-    counts[3] = (int32_t)raw_forced_counts[3];
+    hal_data->counts[3] = (int32_t)raw_forced_counts[3];
   }
   if (hal_data->update_04_position == true) {
     hal_data->update_04_position = false;
 
     raw_forced_counts[4] = hal_data->set_04_position / hal_data->enc_04_scale;
 
-    counts[4] = (int32_t)raw_forced_counts[4];
+    hal_data->counts[4] = (int32_t)raw_forced_counts[4];
   }
 
-  counts[0] += (int16_t)(raw_counts[0] - raw_counts_old[0]);
-  raw_counts_old[0] = raw_counts[0];
+  hal_data->counts[0] += (int16_t)(raw_counts[0] - hal_data->raw_counts_old[0]);
+  hal_data->raw_counts_old[0] = raw_counts[0];
 
-  counts[1] += (int16_t)(raw_counts[1] - raw_counts_old[1]);
-  raw_counts_old[1] = raw_counts[1];
+  hal_data->counts[1] += (int16_t)(raw_counts[1] - hal_data->raw_counts_old[1]);
+  hal_data->raw_counts_old[1] = raw_counts[1];
 
-  counts[2] += (int16_t)(raw_counts[2] - raw_counts_old[2]);
-  raw_counts_old[2] = raw_counts[2];
+  hal_data->counts[2] += (int16_t)(raw_counts[2] - hal_data->raw_counts_old[2]);
+  hal_data->raw_counts_old[2] = raw_counts[2];
 
-  counts[3] += (int16_t)(raw_counts[3] - raw_counts_old[3]);
-  raw_counts_old[3] = raw_counts[3];
+  hal_data->counts[3] += (int16_t)(raw_counts[3] - hal_data->raw_counts_old[3]);
+  hal_data->raw_counts_old[3] = raw_counts[3];
 
-  counts[4] += (int16_t)(raw_counts[4] - raw_counts_old[4]);
-  raw_counts_old[4] = raw_counts[4];
+  hal_data->counts[4] += (int16_t)(raw_counts[4] - hal_data->raw_counts_old[4]);
+  hal_data->raw_counts_old[4] = raw_counts[4];
 
-  *(hal_data->enc_00_position) = counts[0] * hal_data->enc_00_scale;
-  *(hal_data->enc_01_position) = counts[1] * hal_data->enc_01_scale;
-  *(hal_data->enc_02_position) = counts[2] * hal_data->enc_02_scale;
-  *(hal_data->enc_03_position) = counts[3] * hal_data->enc_03_scale;
-  *(hal_data->enc_04_position) = counts[4] * hal_data->enc_04_scale;
+  *(hal_data->enc_00_position) = hal_data->counts[0] * hal_data->enc_00_scale;
+  *(hal_data->enc_01_position) = hal_data->counts[1] * hal_data->enc_01_scale;
+  *(hal_data->enc_02_position) = hal_data->counts[2] * hal_data->enc_02_scale;
+  *(hal_data->enc_03_position) = hal_data->counts[3] * hal_data->enc_03_scale;
+  *(hal_data->enc_04_position) = hal_data->counts[4] * hal_data->enc_04_scale;
 
-  *(hal_data->enc_00_count) = counts[0];
-  *(hal_data->enc_01_count) = counts[1];
-  *(hal_data->enc_02_count) = counts[2];
-  *(hal_data->enc_03_count) = counts[3];
-  *(hal_data->enc_04_count) = counts[4];
+  *(hal_data->enc_00_count) = hal_data->counts[0];
+  *(hal_data->enc_01_count) = hal_data->counts[1];
+  *(hal_data->enc_02_count) = hal_data->counts[2];
+  *(hal_data->enc_03_count) = hal_data->counts[3];
+  *(hal_data->enc_04_count) = hal_data->counts[4];
 }
 
 double calculateFvalue(double dac_value, double enc_scale, double dac_scale) {
@@ -598,9 +597,8 @@ double calculateFvalue(double dac_value, double enc_scale, double dac_scale) {
 }
 
 void lcec_fr4000_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_fr4000_data_t *hal_data = (lcec_fr4000_data_t *)slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
 
   float fValue;
 
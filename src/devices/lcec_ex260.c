@@ -78,9 +78,8 @@ static int lcec_ex260_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_r
 }
 
 static void lcec_ex260_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_ex260_pin_t *hal_data = (lcec_ex260_pin_t *)slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   lcec_ex260_pin_t *pin;
   int i, s;
 
@@ -121,9 +121,8 @@ int lcec_generic_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_reg_t
 
 /// @brief Read from a generic device.
 void lcec_generic_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_generic_pin_t *hal_data = (lcec_generic_pin_t *)slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i, j, offset;
   hal_float_t fval;
 
@@ -174,9 +173,8 @@ void lcec_generic_read(struct lcec_slave *slave, long period) {
 
 /// @brief Write to a generic device.
 void lcec_generic_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_generic_pin_t *hal_data = (lcec_generic_pin_t *)slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i, j, offset;
   hal_float_t fval;
 
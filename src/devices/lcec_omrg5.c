@@ -116,6 +116,9 @@ typedef struct {
   unsigned int latch_fnk_os;
   unsigned int dout_pdo_os;
 
+  lcec_interp_t target_pos_interp;
+  lcec_fb_avg_t curr_pos_avg;
+
   hal_bit_t enable_old;
   long long auto_fault_reset_delay;
 
@@ -248,6 +251,10 @@ static int lcec_omrg5_init(int comp_id, struct lcec_slave *slave, ec_pdo_entry_r
   LCEC_PDO_INIT(pdo_entry_regs, slave->index, slave->vid, slave->pid, 0x60B8, 0x00, &hal_data->latch_fnk_os, NULL);
   LCEC_PDO_INIT(pdo_entry_regs, slave->index, slave->vid, slave->pid, 0x60FE, 0x01, &hal_data->dout_pdo_os, NULL);
 
+  // interpolate the position command and average feedback if the bus runs faster than the servo thread
+  lcec_interp_init(slave, &hal_data->target_pos_interp, &hal_data->target_pos_pdo_os);
+  lcec_fb_avg_init(slave, &hal_data->curr_pos_avg, &hal_data->curr_pos_pdo_os);
+
   // export pins
   if ((err = lcec_pin_newf_list(hal_data, slave_pins, LCEC_MODULE_NAME, master->name, slave->name)) != 0) {
     return err;
@@ -286,9 +293,8 @@ static void lcec_omrg5_check_scales(lcec_omrg5_data_t *hal_data) {
 }
 
 static void lcec_omrg5_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_omrg5_data_t *hal_data = (lcec_omrg5_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint16_t status;
   uint32_t din;
 
@@ -351,9 +357,8 @@ static void lcec_omrg5_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_omrg5_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_omrg5_data_t *hal_data = (lcec_omrg5_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int enable_edge;
   uint16_t control;
 
@@ -386,6 +391,6 @@ static void lcec_omrg5_write(struct lcec_slave *slave, long period) {
 
   // write position command
   *(hal_data->pos_cmd_raw) = (int32_t) (*(hal_data->pos_cmd) * hal_data->pos_scale);
-  EC_WRITE_S32(&pd[hal_data->target_pos_pdo_os], *(hal_data->pos_cmd_raw));
+  lcec_interp_write(&hal_data->target_pos_interp, pd, *(hal_data->pos_cmd_raw));
 }
 
@@ -276,9 +276,8 @@ static int lcec_ph3lm2rm_rm_init(struct lcec_slave *slave, ec_pdo_entry_reg_t *p
 }
 
 static void lcec_ph3lm2rm_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_ph3lm2rm_data_t *hal_data = (lcec_ph3lm2rm_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i;
   lcec_ph3lm2rm_rm_data_t *rm;
   lcec_ph3lm2rm_lm_data_t *lm;
@@ -321,9 +320,8 @@ static void lcec_ph3lm2rm_enc_read(uint8_t *pd, lcec_ph3lm2rm_enc_data_t *ch) {
 }
 
 static void lcec_ph3lm2rm_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_ph3lm2rm_data_t *hal_data = (lcec_ph3lm2rm_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   int i;
   lcec_ph3lm2rm_rm_data_t *rm;
   lcec_ph3lm2rm_lm_data_t *lm;
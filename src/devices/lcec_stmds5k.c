@@ -421,9 +421,8 @@ static void lcec_stmds5k_check_scales(lcec_stmds5k_data_t *hal_data) {
 }
 
 static void lcec_stmds5k_read(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_stmds5k_data_t *hal_data = (lcec_stmds5k_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint8_t dev_state;
   uint16_t speed_state;
   int16_t speed_raw, torque_raw;
@@ -484,9 +483,8 @@ static void lcec_stmds5k_read(struct lcec_slave *slave, long period) {
 }
 
 static void lcec_stmds5k_write(struct lcec_slave *slave, long period) {
-  lcec_master_t *master = slave->master;
   lcec_stmds5k_data_t *hal_data = (lcec_stmds5k_data_t *) slave->hal_data;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   uint8_t dev_ctrl;
   double speed_raw, torque_raw;
 
@@ -73,9 +73,45 @@
 #define LCEC_ABET_VID     0x0000079A
 #define LCEC_MODUSOFT_VID 0x00000907
 
+// name of the domain that slaves are added to by default
+#define LCEC_DEFAULT_DOMAIN_NAME "default"
+
+// name of the domain taking the inputs of the default domain with splitDomains="true"
+#define LCEC_INPUT_DOMAIN_NAME "inputs"
+
 // State update period (ns)
 #define LCEC_STATE_UPDATE_PERIOD 1000000000LL
 
+// default gains of the PI controller syncing the thread to the reference clock
+#define LCEC_PLL_DEFAULT_P_GAIN 0.1
+#define LCEC_PLL_DEFAULT_I_GAIN 0.002
+
+// number of successive cycles within pll-lock-window before pll-locked is set
+#define LCEC_PLL_LOCK_CYCLES 100
+
+// defaults for sync0Shift="auto": measured cycles and safety margin (ns)
+#define LCEC_SYNC0_SHIFT_CYCLES 1000
+#define LCEC_SYNC0_SHIFT_MARGIN 10000
+
+// wire timing for estimating the frame time: bytes per frame (preamble, headers, FCS, gap)
+// and per datagram (header, working counter), ns per byte at 100 MBit/s
+#define LCEC_FRAME_OVERHEAD    40
+#define LCEC_DATAGRAM_OVERHEAD 14
+#define LCEC_NS_PER_BYTE       80
+
+// max. process data per datagram, the master splits larger domains
+#define LCEC_MAX_DATAGRAM_DATA 1486
+
+// time before the send phase (ns) from which on the cycle function busy-waits instead of sleeping
+#define LCEC_SEND_SPIN_TIME 20000
+
+// number of histogram buckets for cycle timing statistics, last one counts overflows
+#define LCEC_TIMING_HIST_BUCKETS 8
+
+// shared memory with per-slave profiling data, read by lcec_top
+#define LCEC_PROFILE_SHMEM_KEY   0xACB572C8
+#define LCEC_PROFILE_SHMEM_MAGIC 0x2F4C7E19
+
 // IDN builder
 #define LCEC_IDN_TYPE_P 0x8000
 #define LCEC_IDN_TYPE_S 0x0000
@@ -88,6 +124,10 @@
 
 #define LCEC_FSOE_SIZE(ch_count, data_len) (LCEC_FSOE_CMD_LEN + ch_count * (data_len + LCEC_FSOE_CRC_LEN) + LCEC_FSOE_CONNID_LEN)
 
+// alignment of the RT slave tables
+#define LCEC_CACHELINE_SIZE     64
+#define LCEC_CACHELINE_ALIGN(x) (((x) + LCEC_CACHELINE_SIZE - 1) & ~((uintptr_t)LCEC_CACHELINE_SIZE - 1))
+
 #define LCEC_MAX_PDO_ENTRY_COUNT 32
 #define LCEC_MAX_PDO_INFO_COUNT  8
 #define LCEC_MAX_SYNC_COUNT      4
@@ -130,8 +170,10 @@ typedef struct {
 
 /// @brief Linked list for holding device type definitions.
 typedef struct lcec_typelinkedlist {
-  const lcec_typelist_t *type;       ///< The type definition.
-  struct lcec_typelinkedlist *next;  ///< Pointer to the next `lcec_typelinkedlist` in the linked list.
+  const lcec_typelist_t *type;            ///< The type definition.
+  struct lcec_typelinkedlist *next;       ///< Pointer to the next `lcec_typelinkedlist` in the linked list.
+  struct lcec_typelinkedlist *next_name;  ///< Next entry in the same name hash bucket.
+  struct lcec_typelinkedlist *next_id;    ///< Next entry in the same vendor/product ID hash bucket.
 } lcec_typelinkedlist_t;
 
 typedef struct {
@@ -140,6 +182,117 @@ typedef struct {
   int data_channels;    ///< Number of data channels.
 } LCEC_CONF_FSOE_T;
 
+/// @brief Phases of the master read/write cycle that are timed.
+typedef enum {
+  LCEC_TIMING_RECEIVE,  ///< `ecrt_master_receive()` and `ecrt_domain_process()`.
+  LCEC_TIMING_READ,     ///< Slave `proc_read` dispatch.
+  LCEC_TIMING_WRITE,    ///< Slave `proc_write` dispatch.
+  LCEC_TIMING_SEND,     ///< Domain queue, DC sync and `ecrt_master_send()`.
+  LCEC_TIMING_LATENCY,  ///< From `ecrt_master_send()` to the next `ecrt_master_receive()`.
+  LCEC_TIMING_PHASE_COUNT
+} lcec_timing_phase_t;
+
+/// @brief Execution time statistics for one cycle phase, in ns.
+typedef struct {
+  hal_u32_t *last;                            ///< Duration of the last cycle.
+  hal_u32_t *min;                             ///< Minimum duration since reset.
+  hal_u32_t *max;                             ///< Maximum duration since reset.
+  hal_u32_t *mean;                            ///< Rolling (exponentially weighted) mean.
+  hal_u32_t *hist[LCEC_TIMING_HIST_BUCKETS];  ///< Histogram of durations, see `timing-hist-width`.
+  uint64_t mean_acc;                          ///< Scaled accumulator for `mean`.
+  int valid;                                  ///< Set after the first sample following a reset.
+} lcec_timing_stat_t;
+
+/// @brief Statistics of the error between the application time and the DC reference clock, in ns.
+typedef struct {
+  hal_s32_t *err_min;              ///< Minimum error of the last complete window.
+  hal_s32_t *err_max;              ///< Maximum error of the last complete window.
+  hal_u32_t *err_rms;              ///< RMS error of the last complete window.
+  hal_u32_t *violations;           ///< Samples outside of `sync_window` since reset.
+  hal_float_t *time_since_resync;  ///< Time since the application time was last reset to the reference clock, in s.
+  hal_u32_t window;                ///< Number of samples per window.
+  hal_u32_t sync_window;           ///< Maximum allowed error.
+  hal_u32_t sample_cycles;         ///< Cycles between two samples, if the reference clock is not read every cycle anyway.
+  int32_t min;                     ///< Minimum error of the current window.
+  int32_t max;                     ///< Maximum error of the current window.
+  uint64_t sq_sum;                 ///< Sum of squared errors of the current window.
+  uint32_t count;                  ///< Number of samples in the current window.
+  uint32_t sample_cnt;             ///< Cycles until the next sample.
+  long long resync_time;           ///< `rtapi_get_time()` of the last resync.
+} lcec_dc_stat_t;
+
+/// @brief Distributed clock timestamps of a master's current cycle, all in ns.
+///
+/// All times are on the application time scale, which the distributed
+/// clocks follow.  Drivers get them with `lcec_slave_timestamp()`.
+typedef struct {
+  uint64_t app_time;      ///< Application time sent with the last frame, whose inputs the drivers see.
+  uint64_t ref_time;      ///< Last reference clock time read, extended to 64 bits, 0 if none yet.
+  uint64_t ref_app_time;  ///< Application time of the frame that `ref_time` was read with.
+  uint64_t receive_time;  ///< Time of the last `ecrt_master_receive()`.
+} lcec_dc_timestamp_t;
+
+/// @brief Execution time statistics for one slave callback, in ns.
+typedef struct {
+  hal_u32_t max;      ///< Maximum duration since reset.
+  hal_u32_t mean;     ///< Rolling (exponentially weighted) mean.
+  uint64_t mean_acc;  ///< Scaled accumulator for `mean`.
+  int valid;          ///< Set after the first sample following a reset.
+} lcec_profile_stat_t;
+
+/// @brief Header of the slave profiling shared memory.
+typedef struct {
+  uint32_t magic;  ///< `LCEC_PROFILE_SHMEM_MAGIC` once initialized.
+  uint32_t count;  ///< Number of records following the header.
+} lcec_profile_header_t;
+
+/// @brief One slave's record in the profiling shared memory.
+typedef struct {
+  volatile uint32_t seq;                   ///< Update counter, odd while the record is being written.
+  char master_name[LCEC_CONF_STR_MAXLEN];  ///< Name of the master.
+  char slave_name[LCEC_CONF_STR_MAXLEN];   ///< Name of the slave.
+  char type_name[LCEC_CONF_STR_MAXLEN];    ///< Slave type, as used in the XML.
+  uint32_t read_max;                       ///< Maximum `proc_read` duration.
+  uint32_t read_mean;                      ///< Mean `proc_read` duration.
+  uint32_t write_max;                      ///< Maximum `proc_write` duration.
+  uint32_t write_mean;                     ///< Mean `proc_write` duration.
+} lcec_profile_record_t;
+
+/// @brief Per-slave profiling data.
+typedef struct {
+  lcec_profile_stat_t read;       ///< `proc_read` statistics.
+  lcec_profile_stat_t write;      ///< `proc_write` statistics.
+  lcec_profile_record_t *record;  ///< Record in the shared memory, if any.
+} lcec_slave_profile_t;
+
+/// @brief Startup phases, see lcec_startup.c.
+typedef enum {
+  LCEC_STARTUP_PARSE,     ///< Reading the configuration from `lcec_conf`.
+  LCEC_STARTUP_REQUEST,   ///< Requesting masters, creating domains and slave configs.
+  LCEC_STARTUP_SLAVES,    ///< SDO/IDN configuration and `proc_init` of all slaves.
+  LCEC_STARTUP_SETUP,     ///< DC, watchdog and PDO setup, slave HAL pins.
+  LCEC_STARTUP_REGISTER,  ///< PDO entry registration.
+  LCEC_STARTUP_ACTIVATE,  ///< `ecrt_master_activate()` and domain mapping.
+  LCEC_STARTUP_HAL,       ///< Master HAL pins and functions.
+  LCEC_STARTUP_PHASE_COUNT
+} lcec_startup_phase_t;
+
+/// @brief Startup timeline.
+typedef struct {
+  long long start;                             ///< Time `rtapi_app_main()` was entered.
+  long long last;                              ///< End of the last recorded phase.
+  long long phases[LCEC_STARTUP_PHASE_COUNT];  ///< Time spent in each phase, summed over all masters.
+  char report[LCEC_CONF_PATH_MAXLEN];          ///< File to write the report to, empty for none.
+} lcec_startup_t;
+
+/// @brief Per-slave startup cost.
+typedef struct {
+  long long config_time;  ///< Time spent on `<sdoConfig>` and `<idnConfig>`.
+  long long init_time;    ///< Time spent in the driver's `proc_init`.
+  int sdo_count;          ///< Number of `lcec_read_sdo()` and `lcec_write_sdo()` transfers.
+  long long sdo_time;     ///< Time spent waiting for these transfers.
+} lcec_slave_startup_t;
+
 typedef struct lcec_master_data {
   hal_u32_t *slaves_responding;
   hal_bit_t *state_init;
@@ -154,7 +307,29 @@ typedef struct lcec_master_data {
   hal_u32_t pll_step;
   hal_u32_t pll_max_err;
   hal_u32_t *pll_reset_cnt;
+  hal_bit_t *pll_locked;
+  hal_float_t pll_p_gain;
+  hal_float_t pll_i_gain;
+  hal_u32_t pll_lock_window;
 #endif
+  hal_u32_t *sync0_send_offset;
+  hal_u32_t *sync0_send_jitter;
+  hal_u32_t *sync0_frame_time;
+  hal_u32_t *bus_overruns;
+  hal_u32_t *send_late;
+  hal_u32_t *frame_datagrams;
+  hal_u32_t *frame_data_len;
+  hal_u32_t *skipped_cycles;
+  hal_bit_t *stats_reset;
+  hal_u32_t timing_hist_width;
+  lcec_timing_stat_t timing[LCEC_TIMING_PHASE_COUNT];
+  lcec_dc_stat_t dc_stats;
+  hal_u32_t *dc_app_time_lo;
+  hal_u32_t *dc_app_time_hi;
+  hal_u32_t *dc_ref_time_lo;
+  hal_u32_t *dc_ref_time_hi;
+  hal_u32_t *dc_receive_time_lo;
+  hal_u32_t *dc_receive_time_hi;
 } lcec_master_data_t;
 
 typedef struct lcec_slave_state {
@@ -166,32 +341,195 @@ typedef struct lcec_slave_state {
   hal_bit_t *state_op;      ///< Is the device in state `OP`?  Equivalant to the `.slave-state-op` HAL pin.
 } lcec_slave_state_t;
 
+/// @brief HAL pins for a process data domain.
+typedef struct {
+  hal_u32_t *working_counter;  ///< Working counter of the last cycle.
+  hal_u32_t *expected_wc;      ///< Working counter of the last complete cycle.
+  hal_u32_t *wc_state;         ///< 0: no slave responded, 1: some slaves responded, 2: all slaves responded.
+  hal_u32_t *missed_frames;    ///< Number of incomplete cycles since the domain was complete for the first time.
+  hal_bit_t *data_valid;       ///< Was the last exchange complete?
+} lcec_domain_data_t;
+
+/// @brief Process data domain of a master.
+typedef struct lcec_domain {
+  struct lcec_domain *prev;            ///< Previous domain.
+  struct lcec_domain *next;            ///< Next domain.
+  char name[LCEC_CONF_STR_MAXLEN];     ///< Name of the domain.
+  ec_domain_t *domain;                 ///< EtherCAT domain structure.
+  unsigned int cycle_divisor;          ///< Exchange this domain every `cycle_divisor` cycles.
+  unsigned int cycle_cnt;              ///< Cycles until the next exchange.
+  int queued;                          ///< Was the domain queued in the last write?
+  int pdo_entry_count;                 ///< Number of PDO entries registered in this domain.
+  unsigned int data_size;              ///< Size of the domain's process data.
+  unsigned int datagram_count;         ///< Number of datagrams the domain is exchanged with.
+  ec_pdo_entry_reg_t *pdo_entry_regs;  ///< PDO entries registered in this domain.
+  ec_domain_state_t state;             ///< Domain state of the last cycle.
+  ec_domain_state_t bus_state;         ///< Domain state of the last exchange of the bus thread.
+  int exchanged;                       ///< Was the domain exchanged by the bus thread since the last read?
+  int hal_pending;                     ///< Was `state` updated by `lcec_bus_read()`, but not the HAL pins?
+  int complete_seen;                   ///< Has the working counter ever been complete?
+  int data_valid;                      ///< Was the last exchange complete?
+  lcec_domain_data_t *hal_data;        ///< HAL pins.
+} lcec_domain_t;
+
+/// @brief Slave callback entry in the master's flattened RT tables.
+typedef struct {
+  lcec_slave_rw_t proc;           ///< `proc_read` or `proc_write` of the slave, never NULL.
+  struct lcec_slave *slave;       ///< The slave to pass to `proc`.
+  lcec_slave_profile_t *profile;  ///< Profiling data of the slave, if enabled.
+  const int *data_valid;          ///< Domain `data_valid` flag to check before a read with `wcPolicy="hold"`, else NULL.
+} lcec_slave_call_t;
+
+/// @brief Part of a callback table, run by a driver worker thread.
+typedef struct {
+  lcec_slave_call_t *first;  ///< First call of the chunk.
+  lcec_slave_call_t *end;    ///< End of the chunk.
+  int write;                 ///< Update the write instead of the read profiling statistics.
+} lcec_call_chunk_t;
+
+/// @brief Slave state polling entry in the master's flattened RT tables.
+typedef struct {
+  ec_slave_config_t *config;           ///< Slave configuration to poll.
+  ec_slave_config_state_t *state;      ///< Where to store the state, points into the slave.
+  lcec_slave_state_t *hal_state_data;  ///< State HAL pins of the slave.
+} lcec_slave_poll_t;
+
+/// @brief Job function for a worker thread.
+typedef void (*lcec_worker_func_t)(void *arg, long period);
+
+/// @brief Realtime worker thread, see lcec_worker.c.
+typedef struct lcec_worker lcec_worker_t;
+
+/// @brief Job function for a job queue, called with the job index.
+typedef int (*lcec_job_func_t)(void *arg, int index);
+
+/// @brief Queue of blocking startup jobs, see lcec_worker.c.
+typedef struct lcec_jobs lcec_jobs_t;
+
+/// @brief Function of a deferred task.
+typedef void (*lcec_deferred_func_t)(void *arg);
+
+/// @brief Task run on an ordinary thread when triggered from realtime code, see lcec_worker.c.
+typedef struct lcec_deferred lcec_deferred_t;
+
+/// @brief Bus thread running the EtherCAT cycle faster than the HAL thread, see lcec_bus.c.
+typedef struct lcec_bus lcec_bus_t;
+
+/// @brief 32 bit setpoint, interpolated by the bus thread between two HAL cycles.
+typedef struct lcec_interp {
+  struct lcec_interp *next;  ///< Next setpoint of the master.
+  unsigned int *pdo_os;      ///< Offset of the setpoint PDO.
+  int32_t target_next;       ///< Target written by the driver in the last HAL cycle.
+  int pending;               ///< `target_next` has not been passed to the bus thread yet.
+  int32_t start;             ///< Setpoint at the start of the current segment.
+  int32_t delta;             ///< Change of the setpoint over the current segment.
+  int32_t delta_prev;        ///< Change of the setpoint over the previous segment.
+  int valid;                 ///< Has a target been passed to the bus thread?
+} lcec_interp_t;
+
+/// @brief 32 bit feedback, averaged over the bus cycles of a HAL cycle.
+typedef struct lcec_fb_avg {
+  struct lcec_fb_avg *next;  ///< Next feedback of the master.
+  unsigned int *pdo_os;      ///< Offset of the feedback PDO.
+  int32_t base;              ///< First value of the current HAL cycle.
+  int64_t sum;               ///< Sum of the differences to `base`.
+  int count;                 ///< Number of values summed up.
+} lcec_fb_avg_t;
+
 typedef struct lcec_master {
-  struct lcec_master *prev;         ///< Next master.
-  struct lcec_master *next;         ///< Previous master.
-  int index;                        ///< Index of this mater.
-  char name[LCEC_CONF_STR_MAXLEN];  ///< Name of master.
-  ec_master_t *master;              ///< EtherCAT master structure.
-  unsigned long mutex;              ///< Mutex for locking operations.
-  int pdo_entry_count;              ///< Number of PDO entry counts registered for master.
+  struct lcec_master *prev;          ///< Next master.
+  struct lcec_master *next;          ///< Previous master.
+  int index;                         ///< Index of this mater.
+  char name[LCEC_CONF_STR_MAXLEN];   ///< Name of master.
+  ec_master_t *master;               ///< EtherCAT master structure.
+  unsigned long mutex;               ///< Mutex for locking operations.
+  int exclusive;                     ///< Only the RT cycle accesses the master, so `mutex` is not used.
+  uint64_t worker_cpus;              ///< CPUs for the master's worker thread, 0 if it has none.
+  lcec_worker_t *worker;             ///< Worker thread running this master in `read-all`/`write-all`.
+  uint64_t driver_cpus;              ///< CPUs for driver worker threads, one thread per CPU.
+  int bus_cycle_multiplier;          ///< EtherCAT cycles per HAL cycle.
+  uint32_t bus_period;               ///< Period of the EtherCAT cycle, in ns.
+  LCEC_BUS_INTERP_T bus_interp;      ///< Interpolation of setpoints between two HAL cycles.
+  LCEC_BUS_FEEDBACK_T bus_feedback;  ///< Feedback passed to the drivers.
+  uint64_t bus_cpus;                 ///< CPUs for the bus thread, 0 to not pin it.
+  lcec_bus_t *bus;                   ///< Bus thread, if `bus_cycle_multiplier` is larger than 1.
+  lcec_interp_t *first_interp;       ///< Setpoints interpolated by the bus thread.
+  lcec_fb_avg_t *first_fb_avg;       ///< Feedback averaged by the bus thread.
+  int driver_worker_count;           ///< Number of driver worker threads.
+  lcec_worker_t **driver_workers;    ///< Driver worker threads.
+  lcec_call_chunk_t *read_chunks;    ///< `read_calls` split up, one chunk per driver worker plus one for the HAL thread.
+  lcec_call_chunk_t *write_chunks;   ///< `write_calls` split up like `read_chunks`.
+  long long cycle_budget;            ///< Max. time of read plus write before non-critical slaves are skipped, 0 for no limit.
+  long long cycle_used;              ///< Time taken by the last read.
+  int budget_exceeded;               ///< Are non-critical slaves skipped in this cycle?
+  int read_noncrit_first;            ///< First entry of `read_calls` of a non-critical slave.
+  int write_noncrit_first;           ///< First entry of `write_calls` of a non-critical slave.
+  int read_serial_first;             ///< First entry of `read_calls` that must run in the HAL thread after the chunks.
+  int write_serial_first;            ///< First entry of `write_calls` that must run in the HAL thread after the chunks.
+  int init_threads;                  ///< Number of slaves initialized at the same time during startup.
+  long long op_time;                 ///< Time from startup until all slaves were in OP, 0 if not yet.
+  int pdo_entry_count;               ///< Number of PDO entry counts registered for master.
   ec_pdo_entry_reg_t *pdo_entry_regs;
-  ec_domain_t *domain;
+  struct lcec_domain *first_domain;  ///< First process data domain.
+  struct lcec_domain *last_domain;   ///< Last process data domain.
+  struct lcec_domain *input_domain;  ///< Domain taking the inputs of the default domain, if split.
+  int send_inputs_used;              ///< Is the input domain sent by `send-inputs` instead of `write`?
+  LCEC_WC_POLICY_T wc_policy;        ///< What to do when a domain's working counter is incomplete.
   uint8_t *process_data;
   int process_data_len;
+  uint8_t *process_data_mem;  ///< Process data memory shared by all domains, if allocated by lcec.
   struct lcec_slave *first_slave;
   struct lcec_slave *last_slave;
   lcec_master_data_t *hal_data;
+  int slave_count;                      ///< Number of slaves, and entries in `state_polls`.
+  lcec_slave_poll_t *state_polls;       ///< Slave state polling table, in slave order.
+  lcec_slave_call_t *read_calls;        ///< Slaves with a `proc_read` callback, in slave order.
+  int read_call_count;                  ///< Number of entries in `read_calls`.
+  lcec_slave_call_t *write_calls;       ///< Slaves with a `proc_write` callback, in slave order.
+  int write_call_count;                 ///< Number of entries in `write_calls`.
+  lcec_slave_call_t *slow_read_calls;   ///< Like `read_calls`, for low priority slaves.
+  int slow_read_call_count;             ///< Number of entries in `slow_read_calls`.
+  lcec_slave_call_t *slow_write_calls;  ///< Like `write_calls`, for low priority slaves.
+  int slow_write_call_count;            ///< Number of entries in `slow_write_calls`.
+  void *rt_tables;                      ///< Unaligned allocation holding the tables above.
+  uint8_t *slow_data;                   ///< Process data seen by the low priority slaves, exchanged under `mutex`.
+  uint8_t *slow_snapshot;               ///< `slow_data` as of the last `read-slow`, to find the changed outputs.
+  uint8_t *slow_out;                    ///< Outputs changed by `write-slow`, not yet copied to `process_data`.
+  uint8_t *slow_out_mask;               ///< Bytes of `slow_out` that are pending.
+  int slow_out_pending;                 ///< Are any bytes of `slow_out` pending?
   uint64_t app_time_base;
   uint32_t app_time_period;
   long period_last;
   int sync_ref_cnt;
   int sync_ref_cycles;
   long long state_update_timer;
+  long long state_update_period;  ///< Time between two slave state sweeps.
+  int state_update_slaves;        ///< Max. number of slave states polled per cycle, 0 for all at once.
+  int state_update_next;          ///< Index of the next slave to poll in the current sweep, -1 when idle.
   ec_master_state_t ms;
+  int profile_slaves;              ///< Measure each slave's read/write callbacks.
+  long long profile_update_timer;  ///< Time until the next profiling shared memory update.
+  uint32_t app_time_last;          ///< Lower 32 bits of the application time sent in the last cycle.
+  uint64_t app_time_start;         ///< First application time, the phase reference of the DC cycles.
+  uint32_t frame_time;             ///< Estimated time from sending a frame until it has passed the last slave, in ns.
+  int sync0_shift_auto;            ///< Some slave uses `sync0Shift="auto"`.
+  int sync0_shift_cycles;          ///< Cycles left to measure for `sync0Shift="auto"`.
+  int sync0_shift_samples;         ///< Number of send times measured so far.
+  uint32_t sync0_send_phase;       ///< Send time within the DC cycle of the first measurement.
+  int32_t sync0_send_min;          ///< Earliest send time, relative to `sync0_send_phase`.
+  int32_t sync0_send_max;          ///< Latest send time, relative to `sync0_send_phase`.
+  uint32_t sync0_send_offset;      ///< Measured send time within the DC cycle, for `sync0_task`.
+  lcec_deferred_t *sync0_task;     ///< Applies the measured `sync0Shift` outside of the cycle.
+  int32_t send_offset;             ///< Time from the start of the DC cycle to `ecrt_master_send()`, -1 to send right away.
+  long long send_time;             ///< Time of the last `ecrt_master_send()`, 0 before the first.
+  long long app_time_clock;        ///< Time the application time of the last cycle was taken at.
+  lcec_dc_timestamp_t timestamp;   ///< Distributed clock timestamps of the current cycle.
 #ifdef RTAPI_TASK_PLL_SUPPORT
   uint64_t dc_ref;
-  uint32_t app_time_last;
   int dc_time_valid_last;
+  LCEC_PLL_MODE_T pll_mode;  ///< Controller for syncing the thread to the reference clock.
+  double pll_integral;       ///< Integral part of the PI controller, in ns.
+  int pll_lock_cnt;          ///< Number of successive cycles within `pll-lock-window`.
 #endif
 } lcec_master_t;
 
@@ -202,6 +540,8 @@ typedef struct {
   int32_t sync0Shift;
   uint32_t sync1Cycle;
   int32_t sync1Shift;
+  int sync0ShiftAuto;        ///< Compute `sync0Shift` from the measured bus timing.
+  int32_t sync0ShiftMargin;  ///< Safety margin added to the computed `sync0Shift`, in ns.
 } lcec_slave_dc_t;
 
 /// @brief Slave Watchdog configuration.
@@ -240,9 +580,11 @@ typedef struct lcec_slave {
   struct lcec_master *master;                ///< Master for this slave
   int index;                                 ///< Index of this slave.
   char name[LCEC_CONF_STR_MAXLEN];           ///< Slave name.
+  char type_name[LCEC_CONF_STR_MAXLEN];      ///< Slave type name, as used in the XML.
   uint32_t vid;                              ///< Slave's vendor ID
   uint32_t pid;                              ///< Slave's EtherCAT PID/device ID.
   int pdo_entry_count;                       ///< Number of PDO entries for this device.
+  ec_pdo_entry_reg_t *pdo_entry_regs;        ///< This slave's part of the master's PDO entry registrations.
   ec_sync_info_t *sync_info;                 ///< Sync Manager configuration.
   ec_slave_config_t *config;                 ///< Configuration data.
   ec_slave_config_state_t state;             ///< Slave state.
@@ -266,8 +608,52 @@ typedef struct lcec_slave {
   unsigned int *fsoe_slave_offset;           ///< FSoE slave offset.
   unsigned int *fsoe_master_offset;          ///< FSoE master offset.
   uint64_t flags;                            ///< Flags, as defined by the driver itself.
+  lcec_slave_profile_t *profile;             ///< Callback profiling data, if enabled.
+  struct lcec_domain *domain;                ///< Domain for this slave's PDOs.
+  struct lcec_domain **sm_domains;           ///< Per sync manager domain overrides, if any.
+  int low_priority;                          ///< Run callbacks in the `read-slow`/`write-slow` functions.
+  int non_critical;                          ///< Skip callbacks when the master's cycle budget is exceeded.
+  lcec_slave_startup_t startup;              ///< Startup cost of this slave.
 } lcec_slave_t;
 
+/// @brief Get the distributed clock timestamps of a slave's master.
+///
+/// In `proc_read` and `proc_write`, `app_time` is the time the slave's
+/// current inputs belong to.
+static inline const lcec_dc_timestamp_t *lcec_slave_timestamp(const lcec_slave_t *slave) { return &slave->master->timestamp; }
+
+/// @brief Extend a 32-bit distributed clock time, like a latch timestamp, to 64 bits.
+///
+/// The time must be within about 2 s of the current application time.
+static inline uint64_t lcec_dc_time_extend(const lcec_slave_t *slave, uint32_t dc_time) {
+  uint64_t base = slave->master->timestamp.app_time;
+
+  return base + (int32_t)(dc_time - (uint32_t)base);
+}
+
+/// @brief Get the process data a slave's driver addresses its PDO offsets in.
+///
+/// Low priority slaves run in the slow thread, so they get a private
+/// copy that `read-slow` and `write-slow` exchange with the master's.
+static inline uint8_t *lcec_slave_process_data(const lcec_slave_t *slave) {
+  return slave->low_priority ? slave->master->slow_data : slave->master->process_data;
+}
+
+/// @brief Get the domain a slave's inputs are exchanged in.
+static inline struct lcec_domain *lcec_slave_input_domain(const lcec_slave_t *slave) {
+  // the inputs of a split default domain are exchanged by the input domain
+  if (slave->domain == slave->master->first_domain && slave->master->input_domain != NULL) {
+    return slave->master->input_domain;
+  }
+  return slave->domain;
+}
+
+/// @brief Check if the process data of a slave was exchanged completely in this cycle.
+///
+/// Drivers may use this in `proc_read` to hold their last feedback
+/// instead of passing on stale inputs.
+static inline int lcec_slave_data_valid(const lcec_slave_t *slave) { return lcec_slave_input_domain(slave)->data_valid; }
+
 /// @brief HAL pin description.
 typedef struct {
   hal_type_t type;    ///< HAL type of this pin (`HAL_BIT`, `HAL_FLOAT`, `HAL_S32`, or `HAL_U32`).
@@ -325,7 +711,40 @@ void lcec_syncs_init(lcec_syncs_t *syncs);
 void lcec_syncs_add_sync(lcec_syncs_t *syncs, ec_direction_t dir, ec_watchdog_mode_t watchdog_mode);
 void lcec_syncs_add_pdo_info(lcec_syncs_t *syncs, uint16_t index);
 void lcec_syncs_add_pdo_entry(lcec_syncs_t *syncs, uint16_t index, uint8_t subindex, uint8_t bit_length);
+int lcec_timing_init_hal(lcec_timing_stat_t *stat, const char *pfx, const char *phase);
+void lcec_timing_reset(lcec_timing_stat_t *stat);
+void lcec_timing_update(lcec_timing_stat_t *stat, long long duration, hal_u32_t hist_width);
+int lcec_dc_stats_init_hal(lcec_dc_stat_t *stat, const char *pfx);
+void lcec_dc_stats_reset(lcec_dc_stat_t *stat);
+void lcec_dc_stats_update(lcec_dc_stat_t *stat, int32_t err);
+int lcec_profile_init_hal(struct lcec_slave *slave);
+void lcec_profile_reset(lcec_slave_profile_t *profile);
+void lcec_profile_update(lcec_profile_stat_t *stat, long long duration);
+int lcec_profile_init_shmem(struct lcec_master *first_master);
+void lcec_profile_exit_shmem(void);
+void lcec_profile_publish(struct lcec_master *master);
+lcec_worker_t *lcec_worker_start(const char *name, uint64_t cpu_mask);
+void lcec_worker_run(lcec_worker_t *worker, lcec_worker_func_t func, void *arg, long period);
+void lcec_worker_wait(lcec_worker_t *worker);
+void lcec_worker_stop(lcec_worker_t *worker);
+lcec_jobs_t *lcec_jobs_start(const char *name, int threads, lcec_job_func_t func, void *arg, int count);
+int lcec_jobs_wait(lcec_jobs_t *jobs);
+lcec_deferred_t *lcec_deferred_start(const char *name, lcec_deferred_func_t func, void *arg);
+void lcec_deferred_trigger(lcec_deferred_t *deferred);
+void lcec_deferred_stop(lcec_deferred_t *deferred);
+void lcec_startup_mark(lcec_startup_t *startup, lcec_startup_phase_t phase);
+void lcec_startup_print(const lcec_startup_t *startup, struct lcec_master *first_master);
+int lcec_startup_write(const lcec_startup_t *startup, struct lcec_master *first_master);
+int lcec_bus_start(struct lcec_master *master);
+void lcec_bus_stop(struct lcec_master *master);
+void lcec_bus_read(struct lcec_master *master);
+void lcec_bus_write(struct lcec_master *master);
+void lcec_interp_init(struct lcec_slave *slave, lcec_interp_t *interp, unsigned int *pdo_os);
+void lcec_interp_write(lcec_interp_t *interp, uint8_t *pd, int32_t val);
+void lcec_fb_avg_init(struct lcec_slave *slave, lcec_fb_avg_t *fb, unsigned int *pdo_os);
+
 const lcec_typelist_t *lcec_findslavetype(const char *name);
+const lcec_typelist_t *lcec_findslavetype_id(uint32_t vid, uint32_t pid);
 void lcec_addtype(lcec_typelist_t *type, char *sourcefile);
 void lcec_addtypes(lcec_typelist_t types[], char *sourcefile);
 int lcec_lookupint(const lcec_lookuptable_int_t *table, const char *key, int default_value);
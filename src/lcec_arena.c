@@ -0,0 +1,78 @@
+//
+//    Copyright (C) 2024 The LinuxCNC-Ethercat authors
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+/// @file
+/// @brief Chunked arena allocator for configuration data.
+///
+/// Chunks are allocated with `lcec_zalloc()` and never reused, so
+/// allocations need no extra zeroing.  Each allocation is rounded up to
+/// `LCEC_ARENA_ALIGN`, and the data of a chunk starts aligned right
+/// after its header.
+
+#include "lcec_arena.h"
+
+#define LCEC_ARENA_ROUND(x) (((x) + LCEC_ARENA_ALIGN - 1) & ~((size_t)LCEC_ARENA_ALIGN - 1))
+
+struct lcec_arena_chunk {
+  struct lcec_arena_chunk *prev;  ///< Previous chunk.
+  size_t size;                    ///< Usable size of this chunk.
+  size_t used;                    ///< Bytes already allocated.
+};
+
+/// @brief Initialize an empty arena.
+/// @param chunk_size Size of the chunks, 0 for `LCEC_ARENA_CHUNK_SIZE`.
+void lcec_arena_init(lcec_arena_t *arena, size_t chunk_size) {
+  arena->chunk = NULL;
+  arena->chunk_size = (chunk_size > 0) ? chunk_size : LCEC_ARENA_CHUNK_SIZE;
+}
+
+/// @brief Allocate zeroed memory from an arena.
+/// @return The memory, or NULL if out of memory.
+void *lcec_arena_zalloc(lcec_arena_t *arena, size_t size) {
+  lcec_arena_chunk_t *chunk = arena->chunk;
+  size_t hdr_size = LCEC_ARENA_ROUND(sizeof(lcec_arena_chunk_t));
+  void *p;
+
+  size = LCEC_ARENA_ROUND(size);
+
+  // start a new chunk if the current one is full
+  if (chunk == NULL || chunk->size - chunk->used < size) {
+    chunk = lcec_zalloc(hdr_size + ((size > arena->chunk_size) ? size : arena->chunk_size));
+    if (chunk == NULL) {
+      return NULL;
+    }
+    chunk->size = (size > arena->chunk_size) ? size : arena->chunk_size;
+    chunk->prev = arena->chunk;
+    arena->chunk = chunk;
+  }
+
+  p = (char *)chunk + hdr_size + chunk->used;
+  chunk->used += size;
+  return p;
+}
+
+/// @brief Free all memory of an arena.  The arena can be used again afterwards.
+void lcec_arena_free(lcec_arena_t *arena) {
+  lcec_arena_chunk_t *chunk;
+
+  while (arena->chunk != NULL) {
+    chunk = arena->chunk;
+    arena->chunk = chunk->prev;
+    lcec_free(chunk);
+  }
+}
@@ -0,0 +1,49 @@
+//
+//    Copyright (C) 2024 The LinuxCNC-Ethercat authors
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+/// @file
+/// @brief Chunked arena allocator for configuration data.
+///
+/// Allocations are zeroed, stay at their address, and can only be
+/// freed all at once with `lcec_arena_free()`.
+
+#ifndef _LCEC_ARENA_H_
+#define _LCEC_ARENA_H_
+
+#include "lcec_rtapi.h"
+
+// default size of a chunk, larger allocations get a chunk of their own
+#define LCEC_ARENA_CHUNK_SIZE 16384
+
+// alignment of allocations
+#define LCEC_ARENA_ALIGN 16
+
+/// @brief Chunk of an arena, see lcec_arena.c.
+typedef struct lcec_arena_chunk lcec_arena_chunk_t;
+
+/// @brief Arena allocator.
+typedef struct {
+  lcec_arena_chunk_t *chunk;  ///< Current chunk, or NULL if nothing was allocated yet.
+  size_t chunk_size;          ///< Size of new chunks.
+} lcec_arena_t;
+
+void lcec_arena_init(lcec_arena_t *arena, size_t chunk_size);
+void *lcec_arena_zalloc(lcec_arena_t *arena, size_t size);
+void lcec_arena_free(lcec_arena_t *arena);
+
+#endif
@@ -0,0 +1,423 @@
+//
+//    Copyright (C) 2024 The LinuxCNC-Ethercat authors
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+/// @file
+/// @brief Bus thread, for running the EtherCAT cycle faster than the HAL thread.
+///
+/// With `busCycleMultiplier="n"`, a master exchanges its process data
+/// `n` times per HAL cycle in a thread of its own.  The HAL functions
+/// then only run the drivers, on a copy of the process data:
+///
+/// - `lcec_bus_read()` copies the domain data to the copy, averaging
+///   feedback registered with `lcec_fb_avg_init()` if configured.
+/// - `lcec_bus_write()` copies the bytes the drivers changed back, and
+///   hands the new targets of setpoints registered with
+///   `lcec_interp_init()` to the bus thread.
+///
+/// The bus thread interpolates these setpoints between two HAL cycles.
+/// All of this happens with the master's lock held.  The bus thread
+/// only ever tries to get the lock, so it does not spin forever when it
+/// preempts a HAL thread holding the lock on the same CPU.
+///
+/// The bus thread is only available in userspace realtime.
+
+#ifndef __KERNEL__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // for CPU affinity
+#endif
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+#include "lcec.h"
+#include "lcec_trace.h"
+
+#ifndef __KERNEL__
+
+// time to sleep while the HAL thread holds the master's lock (ns)
+#define LCEC_BUS_LOCK_RETRY 5000
+
+struct lcec_bus {
+  lcec_master_t *master;  ///< Master exchanged by this thread.
+  pthread_t thread;       ///< Bus thread.
+  uint8_t *domain_data;   ///< The domains' process data, exchanged by the bus thread.
+  uint8_t *shadow;        ///< Process data seen by the drivers, `master->process_data` points here.
+  uint8_t *snapshot;      ///< `shadow` after the last read, to find the bytes written by the drivers.
+  int step;               ///< Bus cycles since the last `lcec_bus_write()`.
+  int stop;               ///< Ask the thread to exit.
+};
+
+static void lcec_bus_timespec_add(struct timespec *ts, long ns) {
+  ts->tv_nsec += ns;
+  while (ts->tv_nsec >= 1000000000L) {
+    ts->tv_nsec -= 1000000000L;
+    ts->tv_sec++;
+  }
+}
+
+static void lcec_bus_lock(lcec_master_t *master) {
+  struct timespec ts;
+
+  while (rtapi_mutex_try(&master->mutex)) {
+    ts.tv_sec = 0;
+    ts.tv_nsec = LCEC_BUS_LOCK_RETRY;
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, NULL);
+  }
+}
+
+/// @brief Get the interpolated value of a setpoint.
+/// @param frac Position within the segment, 0 at its start, 1 at its end.
+static int32_t lcec_interp_value(lcec_interp_t *interp, LCEC_BUS_INTERP_T mode, double frac) {
+  double t2, t3, val;
+
+  if (mode == lcecBusInterpCubic) {
+    // Hermite spline, the slopes at both ends are the changes of the
+    // adjacent segments, so the setpoint velocity has no steps
+    t2 = frac * frac;
+    t3 = t2 * frac;
+    val = (t3 - 2.0 * t2 + frac) * interp->delta_prev + (-2.0 * t3 + 3.0 * t2) * interp->delta + (t3 - t2) * interp->delta;
+  } else {
+    val = frac * interp->delta;
+  }
+
+  // 32 bit arithmetic, so position setpoints may wrap around
+  return (int32_t)((uint32_t)interp->start + (uint32_t)(int32_t)val);
+}
+
+/// @brief One EtherCAT cycle of the bus thread.
+static void lcec_bus_cycle(lcec_bus_t *bus) {
+  lcec_master_t *master = bus->master;
+  lcec_domain_t *domain;
+  lcec_interp_t *interp;
+  lcec_fb_avg_t *fb;
+  uint8_t *pd = bus->domain_data;
+  int32_t val;
+  double frac;
+
+  LCEC_TRACE1(bus_cycle_begin, master->name);
+  lcec_bus_lock(master);
+
+  // receive process data
+  ecrt_master_receive(master->master);
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain->queued) {
+      ecrt_domain_process(domain->domain);
+      ecrt_domain_state(domain->domain, &domain->bus_state);
+      domain->queued = 0;
+      domain->exchanged = 1;
+    }
+  }
+
+  // sum up feedback for averaging
+  if (master->bus_feedback == lcecBusFeedbackAverage) {
+    for (fb = master->first_fb_avg; fb != NULL; fb = fb->next) {
+      val = EC_READ_S32(&pd[*(fb->pdo_os)]);
+      if (fb->count == 0) {
+        fb->base = val;
+      }
+      fb->sum += (int32_t)((uint32_t)val - (uint32_t)fb->base);
+      fb->count++;
+    }
+  }
+
+  // interpolate setpoints, holding the target if the HAL thread is late
+  if (bus->step < master->bus_cycle_multiplier) {
+    bus->step++;
+  }
+  frac = (double)bus->step / master->bus_cycle_multiplier;
+  for (interp = master->first_interp; interp != NULL; interp = interp->next) {
+    if (interp->valid) {
+      EC_WRITE_S32(&pd[*(interp->pdo_os)], lcec_interp_value(interp, master->bus_interp, frac));
+    }
+  }
+
+  // queue domains
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain->pdo_entry_count > 0 && domain->cycle_cnt == 0) {
+      ecrt_domain_queue(domain->domain);
+      domain->queued = 1;
+    }
+    if (++domain->cycle_cnt >= domain->cycle_divisor) {
+      domain->cycle_cnt = 0;
+    }
+  }
+
+  // distributed clocks
+  ecrt_master_application_time(master->master, master->app_time_base + rtapi_get_time());
+  if (master->sync_ref_cycles > 0) {
+    if (master->sync_ref_cnt == 0) {
+      master->sync_ref_cnt = master->sync_ref_cycles;
+      ecrt_master_sync_reference_clock(master->master);
+    }
+    master->sync_ref_cnt--;
+  }
+  ecrt_master_sync_slave_clocks(master->master);
+
+  ecrt_master_send(master->master);
+  rtapi_mutex_give(&master->mutex);
+  LCEC_TRACE1(bus_cycle_end, master->name);
+}
+
+static void *lcec_bus_main(void *arg) {
+  lcec_bus_t *bus = arg;
+  lcec_master_t *master = bus->master;
+  struct timespec next, now;
+
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  while (!bus->stop) {
+    lcec_bus_cycle(bus);
+
+    // wait for the next cycle, skip cycles after an overrun
+    lcec_bus_timespec_add(&next, master->bus_period);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > next.tv_sec || (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec)) {
+      (*(master->hal_data->bus_overruns))++;
+      next = now;
+      continue;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+  }
+
+  return NULL;
+}
+
+/// @brief Start the bus thread of a master.
+///
+/// From here on, the drivers work on a copy of the process data.
+/// @return 0 if successful, negative for error.
+int lcec_bus_start(lcec_master_t *master) {
+  lcec_bus_t *bus;
+  pthread_attr_t attr;
+  struct sched_param param;
+  cpu_set_t cpus;
+  int cpu, err;
+
+  bus = lcec_zalloc(sizeof(lcec_bus_t));
+  if (bus == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s bus memory\n", master->name);
+    return -ENOMEM;
+  }
+  bus->master = master;
+  bus->step = master->bus_cycle_multiplier;
+  bus->shadow = lcec_zalloc(master->process_data_len);
+  bus->snapshot = lcec_zalloc(master->process_data_len);
+  if (bus->shadow == NULL || bus->snapshot == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s bus memory\n", master->name);
+    err = -ENOMEM;
+    goto fail1;
+  }
+
+  // let the drivers work on the copy
+  bus->domain_data = master->process_data;
+  memcpy(bus->shadow, bus->domain_data, master->process_data_len);
+  memcpy(bus->snapshot, bus->domain_data, master->process_data_len);
+  master->process_data = bus->shadow;
+  master->bus = bus;
+
+  // run with the highest realtime priority, above the HAL threads
+  pthread_attr_init(&attr);
+  pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+  pthread_attr_setschedparam(&attr, &param);
+  if (master->bus_cpus != 0) {
+    CPU_ZERO(&cpus);
+    for (cpu = 0; cpu < 64; cpu++) {
+      if (master->bus_cpus & (1ULL << cpu)) {
+        CPU_SET(cpu, &cpus);
+      }
+    }
+    pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+  }
+
+  err = pthread_create(&bus->thread, &attr, lcec_bus_main, bus);
+  if (err == EPERM) {
+    // not allowed to use realtime scheduling, run without it
+    rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "master %s bus thread: unable to set realtime priority\n", master->name);
+    pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+    err = pthread_create(&bus->thread, &attr, lcec_bus_main, bus);
+  }
+  pthread_attr_destroy(&attr);
+  if (err != 0) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s: unable to create bus thread (error %d)\n", master->name, err);
+    err = -err;
+    goto fail2;
+  }
+
+  return 0;
+
+fail2:
+  master->process_data = bus->domain_data;
+  master->bus = NULL;
+fail1:
+  if (bus->shadow != NULL) {
+    lcec_free(bus->shadow);
+  }
+  if (bus->snapshot != NULL) {
+    lcec_free(bus->snapshot);
+  }
+  lcec_free(bus);
+  return err;
+}
+
+/// @brief Stop the bus thread of a master.
+void lcec_bus_stop(lcec_master_t *master) {
+  lcec_bus_t *bus = master->bus;
+
+  bus->stop = 1;
+  pthread_join(bus->thread, NULL);
+
+  master->process_data = bus->domain_data;
+  master->bus = NULL;
+  lcec_free(bus->shadow);
+  lcec_free(bus->snapshot);
+  lcec_free(bus);
+}
+
+/// @brief Copy the bytes the drivers changed to the domain data.
+///
+/// Only changed bytes are copied, so inputs received in the meantime
+/// are kept.
+static void lcec_bus_copy_outputs(lcec_bus_t *bus, int len) {
+  int i;
+
+  for (i = 0; i < len; i++) {
+    if (bus->shadow[i] != bus->snapshot[i]) {
+      bus->domain_data[i] = bus->shadow[i];
+      bus->snapshot[i] = bus->shadow[i];
+    }
+  }
+}
+
+/// @brief Pass the latest inputs to the drivers.
+///
+/// Called by `lcec_read_master()` with the master's lock held.
+void lcec_bus_read(lcec_master_t *master) {
+  lcec_bus_t *bus = master->bus;
+  lcec_domain_t *domain;
+  lcec_fb_avg_t *fb;
+
+  // outputs only reach the shadow between this and lcec_bus_write(), which copies them
+  memcpy(bus->shadow, bus->domain_data, master->process_data_len);
+
+  // replace feedback with its average
+  if (master->bus_feedback == lcecBusFeedbackAverage) {
+    for (fb = master->first_fb_avg; fb != NULL; fb = fb->next) {
+      if (fb->count > 0) {
+        EC_WRITE_S32(&bus->shadow[*(fb->pdo_os)], (int32_t)((uint32_t)fb->base + (uint32_t)(int32_t)(fb->sum / fb->count)));
+      }
+      fb->sum = 0;
+      fb->count = 0;
+    }
+  }
+
+  memcpy(bus->snapshot, bus->shadow, master->process_data_len);
+
+  // domain states of the last exchange
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain->exchanged) {
+      domain->state = domain->bus_state;
+      domain->exchanged = 0;
+      domain->hal_pending = 1;
+    }
+  }
+}
+
+/// @brief Pass the outputs of the drivers to the bus thread.
+///
+/// Called by `lcec_write_master()` with the master's lock held.
+void lcec_bus_write(lcec_master_t *master) {
+  lcec_bus_t *bus = master->bus;
+  lcec_interp_t *interp;
+
+  lcec_bus_copy_outputs(bus, master->process_data_len);
+
+  // start new interpolation segments
+  for (interp = master->first_interp; interp != NULL; interp = interp->next) {
+    if (!interp->pending) {
+      continue;
+    }
+    if (interp->valid) {
+      interp->start = (int32_t)((uint32_t)interp->start + (uint32_t)interp->delta);
+      interp->delta_prev = interp->delta;
+      interp->delta = (int32_t)((uint32_t)interp->target_next - (uint32_t)interp->start);
+    } else {
+      interp->start = interp->target_next;
+      interp->delta_prev = 0;
+      interp->delta = 0;
+      interp->valid = 1;
+    }
+    interp->pending = 0;
+  }
+  bus->step = 0;
+}
+
+#else
+
+int lcec_bus_start(lcec_master_t *master) {
+  rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s: bus threads are not supported in kernel mode\n", master->name);
+  return -EINVAL;
+}
+
+void lcec_bus_stop(lcec_master_t *master) {}
+
+void lcec_bus_read(lcec_master_t *master) {}
+
+void lcec_bus_write(lcec_master_t *master) {}
+
+#endif
+
+/// @brief Register a 32 bit setpoint for interpolation by the bus thread.
+///
+/// Drivers call this from their init function, and write the setpoint
+/// with `lcec_interp_write()`.  Init functions of several slaves may run
+/// at the same time with `initThreads`, so the list is locked.
+/// @param pdo_os Offset of the setpoint PDO, filled in when the PDOs are registered.
+void lcec_interp_init(struct lcec_slave *slave, lcec_interp_t *interp, unsigned int *pdo_os) {
+  lcec_master_t *master = slave->master;
+
+  interp->pdo_os = pdo_os;
+  rtapi_mutex_get(&master->mutex);
+  interp->next = master->first_interp;
+  master->first_interp = interp;
+  rtapi_mutex_give(&master->mutex);
+}
+
+/// @brief Write a setpoint registered with `lcec_interp_init()`.
+///
+/// Without a bus thread, this writes the setpoint to the process data.
+/// Otherwise it becomes the target the bus thread interpolates to.
+void lcec_interp_write(lcec_interp_t *interp, uint8_t *pd, int32_t val) {
+  EC_WRITE_S32(&pd[*(interp->pdo_os)], val);
+  interp->target_next = val;
+  interp->pending = 1;
+}
+
+/// @brief Register a 32 bit feedback PDO for averaging by the bus thread.
+/// @param pdo_os Offset of the feedback PDO, filled in when the PDOs are registered.
+void lcec_fb_avg_init(struct lcec_slave *slave, lcec_fb_avg_t *fb, unsigned int *pdo_os) {
+  lcec_master_t *master = slave->master;
+
+  fb->pdo_os = pdo_os;
+  rtapi_mutex_get(&master->mutex);
+  fb->next = master->first_fb_avg;
+  master->first_fb_avg = fb;
+  rtapi_mutex_give(&master->mutex);
+}
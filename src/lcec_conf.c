@@ -62,7 +62,9 @@ typedef struct {
   LCEC_CONF_OUTBUF_T outputBuf;
 } LCEC_CONF_XML_STATE_T;
 
+static void parseMastersAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr);
 static void parseMasterAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr);
+static void parseDomainAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr);
 static void parseSlaveAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr);
 static void parseDcConfAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr);
 static void parseWatchdogAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr);
@@ -77,8 +79,9 @@ static void parseComplexEntryAttrs(LCEC_CONF_XML_INST_T *inst, int next, const c
 static void parseModParamAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr);
 
 static const LCEC_CONF_XML_HANLDER_T xml_states[] = {
-    {"masters", lcecConfTypeNone, lcecConfTypeMasters, NULL, NULL},
+    {"masters", lcecConfTypeNone, lcecConfTypeMasters, parseMastersAttrs, NULL},
     {"master", lcecConfTypeMasters, lcecConfTypeMaster, parseMasterAttrs, NULL},
+    {"domain", lcecConfTypeMaster, lcecConfTypeDomain, parseDomainAttrs, NULL},
     {"slave", lcecConfTypeMaster, lcecConfTypeSlave, parseSlaveAttrs, NULL},
     {"dcConf", lcecConfTypeSlave, lcecConfTypeDcConf, parseDcConfAttrs, NULL},
     {"watchdog", lcecConfTypeSlave, lcecConfTypeWatchdog, parseWatchdogAttrs, NULL},
@@ -104,17 +107,72 @@ static void exitHandler(int sig) {
   }
 }
 
-int main(int argc, char **argv) {
+/// @brief Parse an XML config file into `state->outputBuf`.
+static int parseConfigFile(const char *filename, LCEC_CONF_XML_STATE_T *state) {
   int ret = 1;
-  char *filename;
   int done;
   char buffer[BUFFSIZE];
   FILE *file;
   LCEC_CONF_NULL_T *end;
+
+  // open file
+  file = fopen(filename, "r");
+  if (file == NULL) {
+    fprintf(stderr, "%s: ERROR: unable to open config file %s\n", modname, filename);
+    goto fail0;
+  }
+
+  // create xml parser
+  if (initXmlInst((LCEC_CONF_XML_INST_T *)state, xml_states)) {
+    fprintf(stderr, "%s: ERROR: Couldn't allocate memory for parser\n", modname);
+    goto fail1;
+  }
+
+  for (done = 0; !done;) {
+    // read block
+    int len = fread(buffer, 1, BUFFSIZE, file);
+    if (ferror(file)) {
+      fprintf(stderr, "%s: ERROR: Couldn't read from file %s\n", modname, filename);
+      goto fail2;
+    }
+
+    // check for EOF
+    done = feof(file);
+
+    // parse current block
+    if (!XML_Parse(state->xml.parser, buffer, len, done)) {
+      fprintf(stderr, "%s: ERROR: Parse error at line %u: %s\n", modname, (unsigned int)XML_GetCurrentLineNumber(state->xml.parser),
+          XML_ErrorString(XML_GetErrorCode(state->xml.parser)));
+      goto fail2;
+    }
+  }
+
+  // set end marker
+  end = addOutputBuffer(&state->outputBuf, sizeof(LCEC_CONF_NULL_T));
+  if (end == NULL) {
+    goto fail2;
+  }
+  end->confType = lcecConfTypeNone;
+  ret = 0;
+
+fail2:
+  XML_ParserFree(state->xml.parser);
+fail1:
+  fclose(file);
+fail0:
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  int ret = 1;
+  char *filename;
+  int use_cache;
+  size_t len;
   void *shmem_ptr;
   LCEC_CONF_HEADER_T *header;
   uint64_t u;
   LCEC_CONF_XML_STATE_T state;
+  LCEC_CONF_CACHE_T cache;
 
   // initialize component
   hal_comp_id = hal_init(modname);
@@ -152,72 +210,59 @@ int main(int argc, char **argv) {
   signal(SIGTERM, exitHandler);
 
   // get config file name
-  if (argc != 2) {
+  use_cache = 1;
+  if (argc == 3 && strcmp(argv[1], "--no-cache") == 0) {
+    use_cache = 0;
+    filename = argv[2];
+  } else if (argc == 2) {
+    filename = argv[1];
+  } else {
     fprintf(stderr, "%s: ERROR: invalid arguments\n", modname);
     goto fail2;
   }
-  filename = argv[1];
-
-  // open file
-  file = fopen(filename, "r");
-  if (file == NULL) {
-    fprintf(stderr, "%s: ERROR: unable to open config file %s\n", modname, filename);
-    goto fail2;
-  }
 
-  // create xml parser
+  // use the cached config if nothing has changed, otherwise parse the XML
   memset(&state, 0, sizeof(state));
-  if (initXmlInst((LCEC_CONF_XML_INST_T *)&state, xml_states)) {
-    fprintf(stderr, "%s: ERROR: Couldn't allocate memory for parser\n", modname);
-    goto fail3;
-  }
-
   initOutputBuffer(&state.outputBuf);
-  for (done = 0; !done;) {
-    // read block
-    int len = fread(buffer, 1, BUFFSIZE, file);
-    if (ferror(file)) {
-      fprintf(stderr, "%s: ERROR: Couldn't read from file %s\n", modname, filename);
-      goto fail4;
-    }
-
-    // check for EOF
-    done = feof(file);
-
-    // parse current block
-    if (!XML_Parse(state.xml.parser, buffer, len, done)) {
-      fprintf(stderr, "%s: ERROR: Parse error at line %u: %s\n", modname, (unsigned int)XML_GetCurrentLineNumber(state.xml.parser),
-          XML_ErrorString(XML_GetErrorCode(state.xml.parser)));
-      goto fail4;
+  if (use_cache && loadConfCache(filename, &cache) == 0) {
+    len = cache.len;
+    *(conf_hal_data->master_count) = cache.master_count;
+    *(conf_hal_data->slave_count) = cache.slave_count;
+  } else {
+    memset(&cache, 0, sizeof(cache));
+    if (parseConfigFile(filename, &state)) {
+      goto fail3;
     }
+    len = state.outputBuf.len;
   }
 
-  // set end marker
-  end = addOutputBuffer(&state.outputBuf, sizeof(LCEC_CONF_NULL_T));
-  if (end == NULL) {
-    goto fail4;
-  }
-  end->confType = lcecConfTypeNone;
-
   // setup shared mem for config
-  shmem_id = rtapi_shmem_new(LCEC_CONF_SHMEM_KEY, hal_comp_id, sizeof(LCEC_CONF_HEADER_T) + state.outputBuf.len);
+  shmem_id = rtapi_shmem_new(LCEC_CONF_SHMEM_KEY, hal_comp_id, sizeof(LCEC_CONF_HEADER_T) + len);
   if (shmem_id < 0) {
     fprintf(stderr, "%s: ERROR: couldn't allocate user/RT shared memory\n", modname);
-    goto fail4;
+    goto fail3;
   }
   if (lcec_rtapi_shmem_getptr(shmem_id, &shmem_ptr) < 0) {
     fprintf(stderr, "%s: ERROR: couldn't map user/RT shared memory\n", modname);
-    goto fail5;
+    goto fail4;
   }
 
   // setup header
   header = shmem_ptr;
   shmem_ptr += sizeof(LCEC_CONF_HEADER_T);
   header->magic = LCEC_CONF_SHMEM_MAGIC;
-  header->length = state.outputBuf.len;
-
-  // copy data and free buffer
-  copyFreeOutputBuffer(&state.outputBuf, shmem_ptr);
+  header->length = len;
+
+  // copy data and free buffer, update the cache after parsing
+  if (cache.data != NULL) {
+    memcpy(shmem_ptr, cache.data, len);
+    freeConfCache(&cache);
+  } else {
+    copyFreeOutputBuffer(&state.outputBuf, shmem_ptr);
+    if (use_cache) {
+      writeConfCache(filename, shmem_ptr, len, *(conf_hal_data->master_count), *(conf_hal_data->slave_count));
+    }
+  }
 
   // everything is fine
   ret = 0;
@@ -228,13 +273,12 @@ int main(int argc, char **argv) {
     fprintf(stderr, "%s: ERROR: error reading exit event\n", modname);
   }
 
-fail5:
-  rtapi_shmem_delete(shmem_id, hal_comp_id);
 fail4:
-  copyFreeOutputBuffer(&state.outputBuf, NULL);
-  XML_ParserFree(state.xml.parser);
+  rtapi_shmem_delete(shmem_id, hal_comp_id);
 fail3:
-  fclose(file);
+  copyFreeOutputBuffer(&state.outputBuf, NULL);
+  freeConfCache(&cache);
+  freeCacheDeps();
 fail2:
   close(exitEvent);
 fail1:
@@ -243,6 +287,38 @@ fail0:
   return ret;
 }
 
+static void parseMastersAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr) {
+  LCEC_CONF_XML_STATE_T *state = (LCEC_CONF_XML_STATE_T *)inst;
+
+  LCEC_CONF_MASTERS_T *p = addOutputBuffer(&state->outputBuf, sizeof(LCEC_CONF_MASTERS_T));
+  if (p == NULL) {
+    XML_StopParser(inst->parser, 0);
+    return;
+  }
+
+  p->confType = lcecConfTypeMasters;
+  while (*attr) {
+    const char *name = *(attr++);
+    const char *val = *(attr++);
+
+    // parse startupReport
+    if (strcmp(name, "startupReport") == 0) {
+      if (strlen(val) >= LCEC_CONF_PATH_MAXLEN) {
+        fprintf(stderr, "%s: ERROR: Invalid masters startupReport %s, path too long\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      strcpy(p->startupReport, val);
+      continue;
+    }
+
+    // handle error
+    fprintf(stderr, "%s: ERROR: Invalid masters attribute %s\n", modname, name);
+    XML_StopParser(inst->parser, 0);
+    return;
+  }
+}
+
 static void parseMasterAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr) {
   LCEC_CONF_XML_STATE_T *state = (LCEC_CONF_XML_STATE_T *)inst;
 
@@ -253,6 +329,7 @@ static void parseMasterAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **
   }
 
   p->confType = lcecConfTypeMaster;
+  p->sendOffset = -1;
   while (*attr) {
     const char *name = *(attr++);
     const char *val = *(attr++);
@@ -282,6 +359,191 @@ static void parseMasterAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **
       continue;
     }
 
+    // parse stateUpdatePeriod
+    if (strcmp(name, "stateUpdatePeriod") == 0) {
+      p->stateUpdatePeriod = atoll(val);
+      if (p->stateUpdatePeriod <= 0) {
+        fprintf(stderr, "%s: ERROR: Invalid master stateUpdatePeriod %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse stateUpdateSlaves
+    if (strcmp(name, "stateUpdateSlaves") == 0) {
+      p->stateUpdateSlaves = atoi(val);
+      if (p->stateUpdateSlaves < 0) {
+        fprintf(stderr, "%s: ERROR: Invalid master stateUpdateSlaves %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse exclusive
+    if (strcmp(name, "exclusive") == 0) {
+      p->exclusive = (strcasecmp(val, "true") == 0);
+      continue;
+    }
+
+    // parse wcPolicy
+    if (strcmp(name, "wcPolicy") == 0) {
+      if (strcasecmp(val, "ignore") == 0) {
+        p->wcPolicy = lcecWcPolicyIgnore;
+        continue;
+      }
+      if (strcasecmp(val, "hold") == 0) {
+        p->wcPolicy = lcecWcPolicyHold;
+        continue;
+      }
+      fprintf(stderr, "%s: ERROR: Invalid master wcPolicy %s\n", modname, val);
+      XML_StopParser(inst->parser, 0);
+      return;
+    }
+
+    // parse pllMode
+    if (strcmp(name, "pllMode") == 0) {
+      if (strcasecmp(val, "bangbang") == 0) {
+        p->pllMode = lcecPllModeBangBang;
+        continue;
+      }
+      if (strcasecmp(val, "pi") == 0) {
+        p->pllMode = lcecPllModePI;
+        continue;
+      }
+      fprintf(stderr, "%s: ERROR: Invalid master pllMode %s\n", modname, val);
+      XML_StopParser(inst->parser, 0);
+      return;
+    }
+
+    // parse workerCpus
+    if (strcmp(name, "workerCpus") == 0) {
+      if (parseCpuList(val, &p->workerCpus) != 0 || p->workerCpus == 0) {
+        fprintf(stderr, "%s: ERROR: Invalid master workerCpus %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse driverCpus
+    if (strcmp(name, "driverCpus") == 0) {
+      if (parseCpuList(val, &p->driverCpus) != 0 || p->driverCpus == 0) {
+        fprintf(stderr, "%s: ERROR: Invalid master driverCpus %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse busCycleMultiplier
+    if (strcmp(name, "busCycleMultiplier") == 0) {
+      p->busCycleMultiplier = atoi(val);
+      if (p->busCycleMultiplier < 1) {
+        fprintf(stderr, "%s: ERROR: Invalid master busCycleMultiplier %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse busInterpolation
+    if (strcmp(name, "busInterpolation") == 0) {
+      if (strcasecmp(val, "linear") == 0) {
+        p->busInterpolation = lcecBusInterpLinear;
+        continue;
+      }
+      if (strcasecmp(val, "cubic") == 0) {
+        p->busInterpolation = lcecBusInterpCubic;
+        continue;
+      }
+      fprintf(stderr, "%s: ERROR: Invalid master busInterpolation %s\n", modname, val);
+      XML_StopParser(inst->parser, 0);
+      return;
+    }
+
+    // parse busFeedback
+    if (strcmp(name, "busFeedback") == 0) {
+      if (strcasecmp(val, "latest") == 0) {
+        p->busFeedback = lcecBusFeedbackLatest;
+        continue;
+      }
+      if (strcasecmp(val, "average") == 0) {
+        p->busFeedback = lcecBusFeedbackAverage;
+        continue;
+      }
+      fprintf(stderr, "%s: ERROR: Invalid master busFeedback %s\n", modname, val);
+      XML_StopParser(inst->parser, 0);
+      return;
+    }
+
+    // parse busCpus
+    if (strcmp(name, "busCpus") == 0) {
+      if (parseCpuList(val, &p->busCpus) != 0 || p->busCpus == 0) {
+        fprintf(stderr, "%s: ERROR: Invalid master busCpus %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse sendOffset
+    if (strcmp(name, "sendOffset") == 0) {
+      p->sendOffset = atoi(val);
+      if (p->sendOffset < 0) {
+        fprintf(stderr, "%s: ERROR: Invalid master sendOffset %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse sync0ShiftCycles
+    if (strcmp(name, "sync0ShiftCycles") == 0) {
+      p->sync0ShiftCycles = atoi(val);
+      if (p->sync0ShiftCycles <= 0) {
+        fprintf(stderr, "%s: ERROR: Invalid master sync0ShiftCycles %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse cycleBudget
+    if (strcmp(name, "cycleBudget") == 0) {
+      p->cycleBudget = atoi(val);
+      if (p->cycleBudget < 1 || p->cycleBudget > 100) {
+        fprintf(stderr, "%s: ERROR: Invalid master cycleBudget %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse initThreads
+    if (strcmp(name, "initThreads") == 0) {
+      p->initThreads = atoi(val);
+      if (p->initThreads < 1 || p->initThreads > LCEC_CONF_MAX_INIT_THREADS) {
+        fprintf(stderr, "%s: ERROR: Invalid master initThreads %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
+    // parse splitDomains
+    if (strcmp(name, "splitDomains") == 0) {
+      p->splitDomains = (strcasecmp(val, "true") == 0);
+      continue;
+    }
+
+    // parse profileSlaves
+    if (strcmp(name, "profileSlaves") == 0) {
+      p->profileSlaves = (strcasecmp(val, "true") == 0);
+      continue;
+    }
+
     // handle error
     fprintf(stderr, "%s: ERROR: Invalid master attribute %s\n", modname, name);
     XML_StopParser(inst->parser, 0);
@@ -293,10 +555,74 @@ static void parseMasterAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **
     snprintf(p->name, LCEC_CONF_STR_MAXLEN, "%d", p->index);
   }
 
+  // set default state update period
+  if (p->stateUpdatePeriod == 0) {
+    p->stateUpdatePeriod = LCEC_STATE_UPDATE_PERIOD;
+  }
+
+  // run the bus at the HAL thread's rate by default
+  if (p->busCycleMultiplier == 0) {
+    p->busCycleMultiplier = 1;
+  }
+
+  // set default sync0Shift="auto" measurement cycles
+  if (p->sync0ShiftCycles == 0) {
+    p->sync0ShiftCycles = LCEC_SYNC0_SHIFT_CYCLES;
+  }
+
   (*(conf_hal_data->master_count))++;
   state->currMaster = p;
 }
 
+static void parseDomainAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr) {
+  LCEC_CONF_XML_STATE_T *state = (LCEC_CONF_XML_STATE_T *)inst;
+  int tmp;
+
+  LCEC_CONF_DOMAIN_T *p = addOutputBuffer(&state->outputBuf, sizeof(LCEC_CONF_DOMAIN_T));
+  if (p == NULL) {
+    XML_StopParser(inst->parser, 0);
+    return;
+  }
+
+  p->confType = lcecConfTypeDomain;
+  p->cycleDivisor = 1;
+  while (*attr) {
+    const char *name = *(attr++);
+    const char *val = *(attr++);
+
+    // parse name
+    if (strcmp(name, "name") == 0) {
+      strncpy(p->name, val, LCEC_CONF_STR_MAXLEN);
+      p->name[LCEC_CONF_STR_MAXLEN - 1] = 0;
+      continue;
+    }
+
+    // parse cycleDivisor
+    if (strcmp(name, "cycleDivisor") == 0) {
+      tmp = atoi(val);
+      if (tmp < 1) {
+        fprintf(stderr, "%s: ERROR: Invalid domain cycleDivisor %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      p->cycleDivisor = tmp;
+      continue;
+    }
+
+    // handle error
+    fprintf(stderr, "%s: ERROR: Invalid domain attribute %s\n", modname, name);
+    XML_StopParser(inst->parser, 0);
+    return;
+  }
+
+  // name is required
+  if (p->name[0] == 0) {
+    fprintf(stderr, "%s: ERROR: Domain has no name attribute\n", modname);
+    XML_StopParser(inst->parser, 0);
+    return;
+  }
+}
+
 static void parseSlaveAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **attr) {
   const lcec_typelist_t *slaveType;
 
@@ -360,6 +686,34 @@ static void parseSlaveAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **a
       continue;
     }
 
+    // parse domain
+    if (strcmp(name, "domain") == 0) {
+      strncpy(p->domain, val, LCEC_CONF_STR_MAXLEN);
+      p->domain[LCEC_CONF_STR_MAXLEN - 1] = 0;
+      continue;
+    }
+
+    // parse priority
+    if (strcmp(name, "priority") == 0) {
+      if (strcasecmp(val, "normal") == 0) {
+        p->lowPriority = 0;
+        continue;
+      }
+      if (strcasecmp(val, "low") == 0) {
+        p->lowPriority = 1;
+        continue;
+      }
+      fprintf(stderr, "%s: ERROR: Invalid slave priority %s\n", modname, val);
+      XML_StopParser(inst->parser, 0);
+      return;
+    }
+
+    // parse critical
+    if (strcmp(name, "critical") == 0) {
+      p->nonCritical = (strcasecmp(val, "false") == 0);
+      continue;
+    }
+
     // generic only attributes
     if (!strcmp(p->typename, "generic")) {
       // parse vid (hex value)
@@ -414,6 +768,7 @@ static void parseDcConfAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **
   }
 
   p->confType = lcecConfTypeDcConf;
+  p->sync0ShiftMargin = LCEC_SYNC0_SHIFT_MARGIN;
   while (*attr) {
     const char *name = *(attr++);
     const char *val = *(attr++);
@@ -432,10 +787,25 @@ static void parseDcConfAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char **
 
     // parse sync0Shift
     if (strcmp(name, "sync0Shift") == 0) {
+      if (strcasecmp(val, "auto") == 0) {
+        p->sync0ShiftAuto = 1;
+        continue;
+      }
       p->sync0Shift = atoi(val);
       continue;
     }
 
+    // parse sync0ShiftMargin
+    if (strcmp(name, "sync0ShiftMargin") == 0) {
+      p->sync0ShiftMargin = atoi(val);
+      if (p->sync0ShiftMargin < 0) {
+        fprintf(stderr, "%s: ERROR: Invalid dcConfig sync0ShiftMargin %s\n", modname, val);
+        XML_StopParser(inst->parser, 0);
+        return;
+      }
+      continue;
+    }
+
     // parse sync1Cycle
     if (strcmp(name, "sync1Cycle") == 0) {
       p->sync1Cycle = parseSyncCycle(state, val);
@@ -747,6 +1117,7 @@ static void parseInitCmdsAttrs(LCEC_CONF_XML_INST_T *inst, int next, const char
   }
 
   // try to parse initCmds
+  addCacheDep(filename);
   if (parseIcmds(state->currSlave, &state->outputBuf, filename)) {
     XML_StopParser(inst->parser, 0);
     return;
@@ -806,6 +1177,13 @@ static void parseSyncManagerAttrs(LCEC_CONF_XML_INST_T *inst, int next, const ch
       return;
     }
 
+    // parse domain
+    if (strcmp(name, "domain") == 0) {
+      strncpy(p->domain, val, LCEC_CONF_STR_MAXLEN);
+      p->domain[LCEC_CONF_STR_MAXLEN - 1] = 0;
+      continue;
+    }
+
     // handle error
     fprintf(stderr, "%s: ERROR: Invalid syncManager attribute %s\n", modname, name);
     XML_StopParser(inst->parser, 0);
@@ -29,12 +29,15 @@
 #define LCEC_CONF_SHMEM_KEY   0xACB572C7
 #define LCEC_CONF_SHMEM_MAGIC 0x036ED5A3
 
-#define LCEC_CONF_STR_MAXLEN 48
+#define LCEC_CONF_STR_MAXLEN  48
+#define LCEC_CONF_PATH_MAXLEN 256
 
 #define LCEC_CONF_SDO_COMPLETE_SUBIDX -1
 #define LCEC_CONF_GENERIC_MAX_SUBPINS 32
 #define LCEC_CONF_GENERIC_MAX_BITLEN  255
 
+#define LCEC_CONF_MAX_INIT_THREADS 64
+
 typedef enum {
   lcecConfTypeNone = 0,
   lcecConfTypeMasters,
@@ -51,7 +54,8 @@ typedef enum {
   lcecConfTypeIdnDataRaw,
   lcecConfTypeInitCmds,
   lcecConfTypeComplexEntry,
-  lcecConfTypeModParam
+  lcecConfTypeModParam,
+  lcecConfTypeDomain
 } LCEC_CONF_TYPE_T;
 
 typedef enum {
@@ -63,19 +67,67 @@ typedef enum {
   lcecPdoEntTypeFloatDoubleIeee,
 } LCEC_PDOENT_TYPE_T;
 
+typedef enum {
+  lcecWcPolicyIgnore,
+  lcecWcPolicyHold,
+} LCEC_WC_POLICY_T;
+
+typedef enum {
+  lcecPllModeBangBang,
+  lcecPllModePI,
+} LCEC_PLL_MODE_T;
+
+typedef enum {
+  lcecBusInterpLinear,
+  lcecBusInterpCubic,
+} LCEC_BUS_INTERP_T;
+
+typedef enum {
+  lcecBusFeedbackLatest,
+  lcecBusFeedbackAverage,
+} LCEC_BUS_FEEDBACK_T;
+
 typedef struct {
   uint32_t magic;
   size_t length;
 } LCEC_CONF_HEADER_T;
 
+typedef struct {
+  LCEC_CONF_TYPE_T confType;
+  char startupReport[LCEC_CONF_PATH_MAXLEN];
+} LCEC_CONF_MASTERS_T;
+
 typedef struct {
   LCEC_CONF_TYPE_T confType;
   int index;
   uint32_t appTimePeriod;
   int refClockSyncCycles;
+  int profileSlaves;
+  long long stateUpdatePeriod;
+  int stateUpdateSlaves;
+  int exclusive;
+  uint64_t workerCpus;
+  uint64_t driverCpus;
+  LCEC_WC_POLICY_T wcPolicy;
+  LCEC_PLL_MODE_T pllMode;
+  int sync0ShiftCycles;
+  int busCycleMultiplier;
+  LCEC_BUS_INTERP_T busInterpolation;
+  LCEC_BUS_FEEDBACK_T busFeedback;
+  uint64_t busCpus;
+  int sendOffset;
+  int splitDomains;
+  int cycleBudget;
+  int initThreads;
   char name[LCEC_CONF_STR_MAXLEN];
 } LCEC_CONF_MASTER_T;
 
+typedef struct {
+  LCEC_CONF_TYPE_T confType;
+  unsigned int cycleDivisor;
+  char name[LCEC_CONF_STR_MAXLEN];
+} LCEC_CONF_DOMAIN_T;
+
 typedef struct {
   LCEC_CONF_TYPE_T confType;
   int index;
@@ -83,6 +135,8 @@ typedef struct {
   uint32_t vid;
   uint32_t pid;
   int configPdos;
+  int lowPriority;
+  int nonCritical;
   unsigned int syncManagerCount;
   unsigned int pdoCount;
   unsigned int pdoEntryCount;
@@ -91,6 +145,7 @@ typedef struct {
   size_t idnConfigLength;
   unsigned int modParamCount;
   char name[LCEC_CONF_STR_MAXLEN];
+  char domain[LCEC_CONF_STR_MAXLEN];
 } LCEC_CONF_SLAVE_T;
 
 typedef struct {
@@ -100,6 +155,8 @@ typedef struct {
   int32_t sync0Shift;
   uint32_t sync1Cycle;
   int32_t sync1Shift;
+  int sync0ShiftAuto;
+  int32_t sync0ShiftMargin;
 } LCEC_CONF_DC_T;
 
 typedef struct {
@@ -113,6 +170,7 @@ typedef struct {
   uint8_t index;
   ec_direction_t dir;
   unsigned int pdoCount;
+  char domain[LCEC_CONF_STR_MAXLEN];
 } LCEC_CONF_SYNCMANAGER_T;
 
 typedef struct {
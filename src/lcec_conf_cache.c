@@ -0,0 +1,351 @@
+//
+//    Copyright (C) 2024 The LinuxCNC-Ethercat authors
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+/// @file
+/// @brief Binary cache of the parsed `lcec_conf` configuration.
+///
+/// After parsing `ethercat.xml`, `lcec_conf` writes the final config
+/// token stream to `ethercat.xml.cache`.  On the next start, the cache
+/// is used instead of parsing the XML if its key still matches.  The
+/// key is a hash over the XML, every `<initCmds>` file it included,
+/// and the build ID of `lcec_conf`, so that a rebuilt driver list also
+/// invalidates the cache.
+///
+/// The cache file layout is a `LCEC_CONF_CACHE_HEADER_T`, the names of
+/// the included files, each terminated by a NUL, and the token stream.
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // for dl_iterate_phdr
+#endif
+
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lcec_conf.h"
+#include "lcec_conf_priv.h"
+
+#define LCEC_CONF_CACHE_MAGIC   0x4C434348  // "LCCH"
+#define LCEC_CONF_CACHE_VERSION 1
+#define LCEC_CONF_CACHE_SUFFIX  ".cache"
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME        0x100000001b3ULL
+
+typedef struct {
+  uint32_t magic;         ///< `LCEC_CONF_CACHE_MAGIC`.
+  uint32_t version;       ///< `LCEC_CONF_CACHE_VERSION`.
+  uint64_t build_id;      ///< Hash of the build ID of `lcec_conf`.
+  uint64_t key;           ///< Hash over the XML and the included files.
+  uint32_t dep_count;     ///< Number of included files.
+  uint32_t dep_len;       ///< Length of the included file names, including the NULs.
+  uint64_t data_len;      ///< Length of the token stream.
+  uint64_t data_sum;      ///< Hash of the token stream.
+  uint32_t master_count;  ///< Number of masters, for `lcec.conf.master-count`.
+  uint32_t slave_count;   ///< Number of slaves, for `lcec.conf.slave-count`.
+} LCEC_CONF_CACHE_HEADER_T;
+
+typedef struct LCEC_CONF_CACHE_DEP {
+  struct LCEC_CONF_CACHE_DEP *next;
+  char name[];
+} LCEC_CONF_CACHE_DEP_T;
+
+static LCEC_CONF_CACHE_DEP_T *first_dep = NULL;
+static LCEC_CONF_CACHE_DEP_T *last_dep = NULL;
+
+static uint64_t hashData(uint64_t hash, const void *data, size_t len) {
+  const uint8_t *p = data;
+
+  for (; len > 0; len--, p++) {
+    hash = (hash ^ *p) * FNV_PRIME;
+  }
+  return hash;
+}
+
+static int hashFile(uint64_t *hash, const char *filename) {
+  char buffer[BUFFSIZE];
+  FILE *file;
+  size_t len;
+  int ret = 0;
+
+  file = fopen(filename, "r");
+  if (file == NULL) {
+    return -1;
+  }
+  while ((len = fread(buffer, 1, BUFFSIZE, file)) > 0) {
+    *hash = hashData(*hash, buffer, len);
+  }
+  if (ferror(file)) {
+    ret = -1;
+  }
+  fclose(file);
+  return ret;
+}
+
+static int hashBuildIdNote(struct dl_phdr_info *info, size_t size, void *data) {
+  const ElfW(Phdr) *phdr;
+  const uint8_t *p, *end;
+  const ElfW(Nhdr) *note;
+  int i;
+
+  // the executable itself comes first
+  for (i = 0; i < info->dlpi_phnum; i++) {
+    phdr = &info->dlpi_phdr[i];
+    if (phdr->p_type != PT_NOTE) {
+      continue;
+    }
+    p = (const uint8_t *)(info->dlpi_addr + phdr->p_vaddr);
+    end = p + phdr->p_memsz;
+    while (p + sizeof(ElfW(Nhdr)) <= end) {
+      note = (const ElfW(Nhdr) *)p;
+      p += sizeof(ElfW(Nhdr));
+      if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && memcmp(p, "GNU", 4) == 0) {
+        *(uint64_t *)data = hashData(FNV_OFFSET_BASIS, p + 4, note->n_descsz);
+        return 1;
+      }
+      p += ((note->n_namesz + 3) & ~3) + ((note->n_descsz + 3) & ~3);
+    }
+  }
+  return 1;
+}
+
+/// @brief Get a hash of the build ID of this program.
+///
+/// Uses the GNU build ID note if there is one, otherwise a hash of the
+/// executable.
+static uint64_t getBuildId(void) {
+  uint64_t hash = 0;
+
+  dl_iterate_phdr(hashBuildIdNote, &hash);
+  if (hash == 0) {
+    hash = FNV_OFFSET_BASIS;
+    if (hashFile(&hash, "/proc/self/exe")) {
+      hash = 0;
+    }
+  }
+  return hash;
+}
+
+/// @brief Hash the XML file and the included files into the cache key.
+/// @param deps The included file names, each terminated by a NUL.
+static int getCacheKey(uint64_t *key, const char *filename, const char *deps, uint32_t dep_count) {
+  *key = FNV_OFFSET_BASIS;
+  if (hashFile(key, filename)) {
+    return -1;
+  }
+  for (; dep_count > 0; dep_count--) {
+    *key = hashData(*key, deps, strlen(deps) + 1);
+    if (hashFile(key, deps)) {
+      return -1;
+    }
+    deps += strlen(deps) + 1;
+  }
+  return 0;
+}
+
+static char *getCacheName(const char *filename) {
+  char *name = malloc(strlen(filename) + sizeof(LCEC_CONF_CACHE_SUFFIX));
+  if (name != NULL) {
+    strcpy(name, filename);
+    strcat(name, LCEC_CONF_CACHE_SUFFIX);
+  }
+  return name;
+}
+
+/// @brief Remember a file included by the config, for the cache key.
+void addCacheDep(const char *filename) {
+  LCEC_CONF_CACHE_DEP_T *dep = calloc(1, sizeof(LCEC_CONF_CACHE_DEP_T) + strlen(filename) + 1);
+  if (dep == NULL) {
+    fprintf(stderr, "%s: ERROR: Couldn't allocate memory for config cache\n", modname);
+    return;
+  }
+  strcpy(dep->name, filename);
+
+  if (first_dep == NULL) {
+    first_dep = dep;
+  }
+  if (last_dep != NULL) {
+    last_dep->next = dep;
+  }
+  last_dep = dep;
+}
+
+/// @brief Free the list of included files.
+void freeCacheDeps(void) {
+  LCEC_CONF_CACHE_DEP_T *dep;
+
+  while (first_dep != NULL) {
+    dep = first_dep;
+    first_dep = dep->next;
+    free(dep);
+  }
+  last_dep = NULL;
+}
+
+/// @brief Load the cached config for an XML file, if it is still valid.
+/// @return 0 if the cache was loaded, non-zero if the XML needs to be parsed.
+int loadConfCache(const char *filename, LCEC_CONF_CACHE_T *cache) {
+  const LCEC_CONF_CACHE_HEADER_T *header;
+  const char *deps;
+  char *name;
+  struct stat st;
+  uint64_t key;
+  int fd;
+
+  memset(cache, 0, sizeof(LCEC_CONF_CACHE_T));
+
+  name = getCacheName(filename);
+  if (name == NULL) {
+    return -1;
+  }
+  fd = open(name, O_RDONLY);
+  free(name);
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(LCEC_CONF_CACHE_HEADER_T)) {
+    close(fd);
+    return -1;
+  }
+  cache->map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (cache->map == MAP_FAILED) {
+    cache->map = NULL;
+    return -1;
+  }
+  cache->map_len = st.st_size;
+
+  // check header
+  header = cache->map;
+  if (header->magic != LCEC_CONF_CACHE_MAGIC || header->version != LCEC_CONF_CACHE_VERSION || header->build_id != getBuildId()) {
+    goto fail;
+  }
+  if (sizeof(LCEC_CONF_CACHE_HEADER_T) + header->dep_len + header->data_len != cache->map_len) {
+    goto fail;
+  }
+  deps = cache->map + sizeof(LCEC_CONF_CACHE_HEADER_T);
+  if (header->dep_len > 0 && deps[header->dep_len - 1] != 0) {
+    goto fail;
+  }
+
+  // check that nothing has changed
+  if (getCacheKey(&key, filename, deps, header->dep_count) || key != header->key) {
+    goto fail;
+  }
+  cache->data = deps + header->dep_len;
+  cache->len = header->data_len;
+  if (hashData(FNV_OFFSET_BASIS, cache->data, cache->len) != header->data_sum) {
+    fprintf(stderr, "%s: WARNING: config cache for %s is corrupt, parsing XML\n", modname, filename);
+    goto fail;
+  }
+  cache->master_count = header->master_count;
+  cache->slave_count = header->slave_count;
+  return 0;
+
+fail:
+  freeConfCache(cache);
+  return -1;
+}
+
+/// @brief Unmap a config cache loaded by `loadConfCache()`.
+void freeConfCache(LCEC_CONF_CACHE_T *cache) {
+  if (cache->map != NULL) {
+    munmap(cache->map, cache->map_len);
+  }
+  memset(cache, 0, sizeof(LCEC_CONF_CACHE_T));
+}
+
+/// @brief Write the token stream of a parsed XML file to its cache.
+///
+/// The cache is written to a temporary file first and then renamed, so
+/// that a concurrent or aborted run never sees a partial cache.
+/// Errors are reported, but are not fatal.
+void writeConfCache(const char *filename, const void *data, size_t len, uint32_t master_count, uint32_t slave_count) {
+  LCEC_CONF_CACHE_HEADER_T header;
+  LCEC_CONF_CACHE_DEP_T *dep;
+  char *deps = NULL, *p;
+  char *name, *tmpname = NULL;
+  FILE *file;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = LCEC_CONF_CACHE_MAGIC;
+  header.version = LCEC_CONF_CACHE_VERSION;
+  header.build_id = getBuildId();
+  if (header.build_id == 0) {
+    return;
+  }
+  header.data_len = len;
+  header.data_sum = hashData(FNV_OFFSET_BASIS, data, len);
+  header.master_count = master_count;
+  header.slave_count = slave_count;
+
+  name = getCacheName(filename);
+  if (name == NULL) {
+    goto fail0;
+  }
+  tmpname = malloc(strlen(name) + 5);
+  if (tmpname == NULL) {
+    goto fail0;
+  }
+  sprintf(tmpname, "%s.tmp", name);
+
+  // collect the included files
+  for (dep = first_dep; dep != NULL; dep = dep->next) {
+    header.dep_count++;
+    header.dep_len += strlen(dep->name) + 1;
+  }
+  deps = malloc(header.dep_len + 1);
+  if (deps == NULL) {
+    goto fail0;
+  }
+  for (dep = first_dep, p = deps; dep != NULL; dep = dep->next) {
+    strcpy(p, dep->name);
+    p += strlen(dep->name) + 1;
+  }
+  if (getCacheKey(&header.key, filename, deps, header.dep_count)) {
+    goto fail0;
+  }
+
+  file = fopen(tmpname, "w");
+  if (file == NULL) {
+    fprintf(stderr, "%s: WARNING: unable to write config cache %s\n", modname, name);
+    goto fail0;
+  }
+  if (fwrite(&header, sizeof(header), 1, file) != 1 || fwrite(deps, 1, header.dep_len, file) != header.dep_len ||
+      fwrite(data, 1, len, file) != len) {
+    fprintf(stderr, "%s: WARNING: unable to write config cache %s\n", modname, name);
+    fclose(file);
+    unlink(tmpname);
+    goto fail0;
+  }
+  if (fclose(file) != 0 || rename(tmpname, name) != 0) {
+    fprintf(stderr, "%s: WARNING: unable to write config cache %s\n", modname, name);
+    unlink(tmpname);
+  }
+
+fail0:
+  free(deps);
+  free(tmpname);
+  free(name);
+}
@@ -23,6 +23,8 @@
 
 #include <expat.h>
 
+#include "lcec_arena.h"
+
 #define BUFFSIZE 8192
 
 struct LCEC_CONF_XML_HANLDER;
@@ -50,8 +52,19 @@ typedef struct {
   LCEC_CONF_OUTBUF_ITEM_T *head;
   LCEC_CONF_OUTBUF_ITEM_T *tail;
   size_t len;
+  lcec_arena_t arena;  ///< Memory of the items, freed by copyFreeOutputBuffer().
 } LCEC_CONF_OUTBUF_T;
 
+/// @brief Config token stream loaded from the cache, see lcec_conf_cache.c.
+typedef struct {
+  void *map;              ///< Mapping of the cache file.
+  size_t map_len;         ///< Length of the mapping.
+  const void *data;       ///< Token stream.
+  size_t len;             ///< Length of the token stream.
+  uint32_t master_count;  ///< Number of masters in the config.
+  uint32_t slave_count;   ///< Number of slaves in the config.
+} LCEC_CONF_CACHE_T;
+
 extern char *modname;
 
 void initOutputBuffer(LCEC_CONF_OUTBUF_T *buf);
@@ -60,8 +73,15 @@ void copyFreeOutputBuffer(LCEC_CONF_OUTBUF_T *buf, void *dest);
 
 int parseIcmds(LCEC_CONF_SLAVE_T *slave, LCEC_CONF_OUTBUF_T *outputBuf, const char *filename);
 
+void addCacheDep(const char *filename);
+void freeCacheDeps(void);
+int loadConfCache(const char *filename, LCEC_CONF_CACHE_T *cache);
+void freeConfCache(LCEC_CONF_CACHE_T *cache);
+void writeConfCache(const char *filename, const void *data, size_t len, uint32_t master_count, uint32_t slave_count);
+
 int initXmlInst(LCEC_CONF_XML_INST_T *inst, const LCEC_CONF_XML_HANLDER_T *states);
 
 int parseHex(const char *s, int slen, uint8_t *buf);
+int parseCpuList(const char *s, uint64_t *mask);
 
 #endif
@@ -19,6 +19,7 @@
 /// @file
 
 #include <ctype.h>
+#include <stdlib.h>
 #include <expat.h>
 #include <stdio.h>
 #include <string.h>
@@ -36,10 +37,11 @@ void initOutputBuffer(LCEC_CONF_OUTBUF_T *buf) {
   buf->head = NULL;
   buf->tail = NULL;
   buf->len = 0;
+  lcec_arena_init(&buf->arena, 0);
 }
 
 void *addOutputBuffer(LCEC_CONF_OUTBUF_T *buf, size_t len) {
-  void *p = calloc(1, sizeof(LCEC_CONF_OUTBUF_ITEM_T) + len);
+  void *p = lcec_arena_zalloc(&buf->arena, sizeof(LCEC_CONF_OUTBUF_ITEM_T) + len);
   if (p == NULL) {
     fprintf(stderr, "%s: ERROR: Couldn't allocate memory for config token\n", modname);
     return NULL;
@@ -73,8 +75,10 @@ void copyFreeOutputBuffer(LCEC_CONF_OUTBUF_T *buf, void *dest) {
       dest += buf->head->len;
     }
     buf->head = buf->head->next;
-    free(p);
   }
+
+  buf->tail = NULL;
+  lcec_arena_free(&buf->arena);
 }
 
 int initXmlInst(LCEC_CONF_XML_INST_T *inst, const LCEC_CONF_XML_HANLDER_T *states) {
@@ -179,3 +183,41 @@ int parseHex(const char *s, int slen, uint8_t *buf) {
 
   return len;
 }
+
+int parseCpuList(const char *s, uint64_t *mask) {
+  char *end;
+  long first, last;
+
+  *mask = 0;
+  while (1) {
+    // get cpu or first cpu of range
+    first = strtol(s, &end, 10);
+    if (end == s || first < 0 || first >= 64) {
+      return -1;
+    }
+    s = end;
+
+    // get last cpu of range
+    last = first;
+    if (*s == '-') {
+      s++;
+      last = strtol(s, &end, 10);
+      if (end == s || last < first || last >= 64) {
+        return -1;
+      }
+      s = end;
+    }
+
+    for (; first <= last; first++) {
+      *mask |= 1ULL << first;
+    }
+
+    if (*s == 0) {
+      return 0;
+    }
+    if (*s != ',') {
+      return -1;
+    }
+    s++;
+  }
+}
@@ -21,34 +21,86 @@
 
 #include "lcec.h"
 
+// number of hash buckets, must be a power of 2
+#define LCEC_TYPES_HASH_SIZE 1024
+
 lcec_typelinkedlist_t *typeslist = NULL;
+static lcec_typelinkedlist_t *typeslist_tail = NULL;
+
+// hash tables for lookups by name and by vendor/product ID
+static lcec_typelinkedlist_t *types_by_name[LCEC_TYPES_HASH_SIZE];
+static lcec_typelinkedlist_t *types_by_id[LCEC_TYPES_HASH_SIZE];
+
+/// @brief Hash a type name (FNV-1a).
+static unsigned int lcec_type_name_hash(const char *name) {
+  uint32_t hash = 0x811c9dc5;
+
+  for (; *name != 0; name++) {
+    hash = (hash ^ (uint8_t)*name) * 0x01000193;
+  }
+  return hash & (LCEC_TYPES_HASH_SIZE - 1);
+}
+
+/// @brief Hash a vendor/product ID pair.
+static unsigned int lcec_type_id_hash(uint32_t vid, uint32_t pid) {
+  uint32_t hash = (pid ^ (vid * 0x9e3779b1)) * 0x85ebca6b;
+
+  return (hash ^ (hash >> 16)) & (LCEC_TYPES_HASH_SIZE - 1);
+}
 
 /// @brief Register a single slave type with LinuxCNC-Ethercat.
+///
+/// Type names must be unique.  A type whose name is already registered
+/// is reported and ignored, so the first definition wins.
 /// @param[in] type the definition of the device type to add.
 void lcec_addtype(lcec_typelist_t *type, char *sourcefile) {
   lcec_typelinkedlist_t *t, *l;
+  unsigned int name_hash, id_hash;
+
+  type->sourcefile = sourcefile;
+
+  // check for duplicate names
+  name_hash = lcec_type_name_hash(type->name);
+  for (t = types_by_name[name_hash]; t != NULL; t = t->next_name) {
+    if (strcmp(t->type->name, type->name) == 0) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "duplicate slave type %s in %s, already defined in %s\n", type->name, sourcefile,
+          t->type->sourcefile);
+      return;
+    }
+  }
 
   // using malloc instead of hal_malloc because this can be called
   // from either lcec.so (inside of LinuxCNC) or lcec_conf (a
   // standalone binary).
   t = malloc(sizeof(lcec_typelinkedlist_t));
-  type->sourcefile = sourcefile;
+  if (t == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "unable to allocate memory for slave type %s\n", type->name);
+    return;
+  }
   t->type = type;
   t->next = NULL;
 
-  if (typeslist == NULL) {
+  // append to the list, keeping the registration order
+  if (typeslist_tail == NULL) {
     typeslist = t;
   } else {
-    // This should really validate that we don't have duplicate names,
-    // but there's no good way to print error messages here.  If we're
-    // running in lcec_main, then we would need to use different code
-    // from lcec_conf.
-    //
-    // Note that if there are duplicate names, then the first match
-    // found will win in lcec_findslavetype, below.
-    for (l = typeslist; l->next != NULL; l = l->next)
+    typeslist_tail->next = t;
+  }
+  typeslist_tail = t;
+
+  // add to the hash tables.  Types sharing a vendor/product ID are
+  // appended, so the first one registered is found first.
+  t->next_name = types_by_name[name_hash];
+  types_by_name[name_hash] = t;
+
+  id_hash = lcec_type_id_hash(type->vid, type->pid);
+  t->next_id = NULL;
+  if (types_by_id[id_hash] == NULL) {
+    types_by_id[id_hash] = t;
+  } else {
+    for (l = types_by_id[id_hash]; l->next_id != NULL; l = l->next_id)
       ;
-    l->next = t;
+    l->next_id = t;
   }
 }
 
@@ -68,11 +120,29 @@ void lcec_addtypes(lcec_typelist_t types[], char *sourcefile) {
 const lcec_typelist_t *lcec_findslavetype(const char *name) {
   lcec_typelinkedlist_t *tl;
 
-  for (tl = typeslist; tl != NULL && tl->type != NULL && strcmp(tl->type->name, name); tl = tl->next)
-    ;
+  for (tl = types_by_name[lcec_type_name_hash(name)]; tl != NULL; tl = tl->next_name) {
+    if (strcmp(tl->type->name, name) == 0) {
+      return tl->type;
+    }
+  }
+
+  // Not found
+  return NULL;
+}
+
+/// @brief Find a slave type by vendor and product ID, for detecting slaves on the bus.
+///
+/// If several types share the ID, the first one registered is returned.
+/// @param[in] vid the EtherCAT vendor ID.
+/// @param[in] pid the EtherCAT product ID.
+/// @returns a pointer to the `lcec_typelist_t` for the slave, or NULL if the type is not found.
+const lcec_typelist_t *lcec_findslavetype_id(uint32_t vid, uint32_t pid) {
+  lcec_typelinkedlist_t *tl;
 
-  if (tl != NULL) {
-    return tl->type;
+  for (tl = types_by_id[lcec_type_id_hash(vid, pid)]; tl != NULL; tl = tl->next_id) {
+    if (tl->type->vid == vid && tl->type->pid == pid) {
+      return tl->type;
+    }
   }
 
   // Not found
@@ -20,6 +20,7 @@
 /// @brief Ethercat library code
 
 #include "lcec.h"
+#include "lcec_trace.h"
 
 static int lcec_param_newfv(hal_type_t type, hal_pin_dir_t dir, void *data_addr, const char *fmt, va_list ap);
 static int lcec_param_newfv_list(void *base, const lcec_pindesc_t *list, va_list ap);
@@ -40,8 +41,7 @@ lcec_slave_t *lcec_slave_by_index(struct lcec_master *master, int index) {
 
 /// @brief Copy FSoE (Safety over EtherCAT / FailSafe over EtherCAT) data between slaves and masters.
 void copy_fsoe_data(struct lcec_slave *slave, unsigned int slave_offset, unsigned int master_offset) {
-  lcec_master_t *master = slave->master;
-  uint8_t *pd = master->process_data;
+  uint8_t *pd = lcec_slave_process_data(slave);
   const LCEC_CONF_FSOE_T *fsoeConf = slave->fsoeConf;
 
   if (fsoeConf == NULL) {
@@ -108,8 +108,15 @@ int lcec_read_sdo(struct lcec_slave *slave, uint16_t index, uint8_t subindex, ui
   int err;
   size_t result_size;
   uint32_t abort_code;
-
-  if ((err = ecrt_master_sdo_upload(master->master, slave->index, index, subindex, target, size, &result_size, &abort_code))) {
+  long long t_start;
+
+  LCEC_TRACE3(sdo_read_begin, slave->name, index, subindex);
+  t_start = lcec_get_time_ns();
+  err = ecrt_master_sdo_upload(master->master, slave->index, index, subindex, target, size, &result_size, &abort_code);
+  slave->startup.sdo_time += lcec_get_time_ns() - t_start;
+  slave->startup.sdo_count++;
+  LCEC_TRACE4(sdo_read_end, slave->name, index, subindex, err);
+  if (err) {
     rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "slave %s.%s: Failed to execute SDO upload (0x%04x:0x%02x, error %d, abort_code %08x)\n",
         master->name, slave->name, index, subindex, err, abort_code);
     return -1;
@@ -151,8 +158,15 @@ int lcec_write_sdo(struct lcec_slave *slave, uint16_t index, uint8_t subindex, u
   lcec_master_t *master = slave->master;
   int err;
   uint32_t abort_code;
-
-  if ((err = ecrt_master_sdo_download(master->master, slave->index, index, subindex, value, size, &abort_code))) {
+  long long t_start;
+
+  LCEC_TRACE3(sdo_write_begin, slave->name, index, subindex);
+  t_start = lcec_get_time_ns();
+  err = ecrt_master_sdo_download(master->master, slave->index, index, subindex, value, size, &abort_code);
+  slave->startup.sdo_time += lcec_get_time_ns() - t_start;
+  slave->startup.sdo_count++;
+  LCEC_TRACE4(sdo_write_end, slave->name, index, subindex, err);
+  if (err) {
     rtapi_print_msg(RTAPI_MSG_ERR,
         LCEC_MSG_PFX "slave %s.%s: Failed to execute SDO download (0x%04x:0x%02x, size %d, byte0=%d, error %d, abort_code %08x)\n",
         master->name, slave->name, index, subindex, (int)size, (int)value[0], err, abort_code);
@@ -19,8 +19,14 @@
 /// @file
 /// @brief Initialization code for LinuxCNC-Ethercat
 
+#ifndef __KERNEL__
+#include <time.h>
+#endif
+
 #include "devices/lcec_generic.h"
 #include "lcec.h"
+#include "lcec_arena.h"
+#include "lcec_trace.h"
 #include "rtapi_app.h"
 //#include <linuxcnc/rtapi_mutex.h>
 
@@ -46,7 +52,23 @@ static const lcec_pindesc_t master_pins[] = {
     {HAL_S32, HAL_OUT, offsetof(lcec_master_data_t, pll_err), "%s.pll-err"},
     {HAL_S32, HAL_OUT, offsetof(lcec_master_data_t, pll_out), "%s.pll-out"},
     {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, pll_reset_cnt), "%s.pll-reset-count"},
+    {HAL_BIT, HAL_OUT, offsetof(lcec_master_data_t, pll_locked), "%s.pll-locked"},
 #endif
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, sync0_send_offset), "%s.sync0-send-offset"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, sync0_send_jitter), "%s.sync0-send-jitter"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, sync0_frame_time), "%s.sync0-frame-time"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, bus_overruns), "%s.bus-overruns"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, send_late), "%s.send-late"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, frame_datagrams), "%s.frame-datagrams"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, frame_data_len), "%s.frame-data-len"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, skipped_cycles), "%s.skipped-cycles"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, dc_app_time_lo), "%s.dc-app-time-lo"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, dc_app_time_hi), "%s.dc-app-time-hi"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, dc_ref_time_lo), "%s.dc-ref-time-lo"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, dc_ref_time_hi), "%s.dc-ref-time-hi"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, dc_receive_time_lo), "%s.dc-receive-time-lo"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_master_data_t, dc_receive_time_hi), "%s.dc-receive-time-hi"},
+    {HAL_BIT, HAL_IN, offsetof(lcec_master_data_t, stats_reset), "%s.stats-reset"},
     {HAL_TYPE_UNSPECIFIED, HAL_DIR_UNSPECIFIED, -1, NULL},
 };
 
@@ -55,7 +77,21 @@ static const lcec_pindesc_t master_params[] = {
 #ifdef RTAPI_TASK_PLL_SUPPORT
     {HAL_U32, HAL_RW, offsetof(lcec_master_data_t, pll_step), "%s.pll-step"},
     {HAL_U32, HAL_RW, offsetof(lcec_master_data_t, pll_max_err), "%s.pll-max-err"},
+    {HAL_FLOAT, HAL_RW, offsetof(lcec_master_data_t, pll_p_gain), "%s.pll-p-gain"},
+    {HAL_FLOAT, HAL_RW, offsetof(lcec_master_data_t, pll_i_gain), "%s.pll-i-gain"},
+    {HAL_U32, HAL_RW, offsetof(lcec_master_data_t, pll_lock_window), "%s.pll-lock-window"},
 #endif
+    {HAL_U32, HAL_RW, offsetof(lcec_master_data_t, timing_hist_width), "%s.timing-hist-width"},
+    {HAL_TYPE_UNSPECIFIED, HAL_DIR_UNSPECIFIED, -1, NULL},
+};
+
+/// @brief Domain HAL pins
+static const lcec_pindesc_t domain_pins[] = {
+    {HAL_U32, HAL_OUT, offsetof(lcec_domain_data_t, working_counter), "%s.%s.domain.%s.working-counter"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_domain_data_t, expected_wc), "%s.%s.domain.%s.expected-wc"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_domain_data_t, wc_state), "%s.%s.domain.%s.wc-state"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_domain_data_t, missed_frames), "%s.%s.domain.%s.missed-frames"},
+    {HAL_BIT, HAL_OUT, offsetof(lcec_domain_data_t, data_valid), "%s.%s.domain.%s.data-valid"},
     {HAL_TYPE_UNSPECIFIED, HAL_DIR_UNSPECIFIED, -1, NULL},
 };
 
@@ -70,6 +106,15 @@ static const lcec_pindesc_t slave_pins[] = {
     {HAL_TYPE_UNSPECIFIED, HAL_DIR_UNSPECIFIED, -1, NULL},
 };
 
+/// @brief Names of the timed cycle phases, used for HAL pin names
+static const char *timing_phase_names[LCEC_TIMING_PHASE_COUNT] = {
+    [LCEC_TIMING_RECEIVE] = "receive",
+    [LCEC_TIMING_READ] = "read",
+    [LCEC_TIMING_WRITE] = "write",
+    [LCEC_TIMING_SEND] = "send",
+    [LCEC_TIMING_LATENCY] = "latency",
+};
+
 static lcec_master_t *first_master = NULL;
 static lcec_master_t *last_master = NULL;
 extern int lcec_comp_id;
@@ -77,6 +122,11 @@ extern int lcec_comp_id;
 static lcec_master_data_t *global_hal_data;
 static ec_master_state_t global_ms;
 
+static lcec_startup_t startup;
+
+// memory of the parsed configuration, freed by lcec_clear_config()
+static lcec_arena_t config_arena;
+
 int lcec_parse_config(void);
 void lcec_clear_config(void);
 
@@ -87,25 +137,52 @@ static void lcec_release_lock(void *data);
 
 lcec_master_data_t *lcec_init_master_hal(const char *pfx, int global);
 lcec_slave_state_t *lcec_init_slave_state_hal(char *master_name, char *slave_name);
+lcec_domain_data_t *lcec_init_domain_hal(char *master_name, char *domain_name);
 void lcec_update_master_hal(lcec_master_data_t *hal_data, ec_master_state_t *ms);
 void lcec_update_slave_state_hal(lcec_slave_state_t *hal_data, ec_slave_config_state_t *ss);
+void lcec_update_domain_hal(lcec_domain_t *domain);
 static int lcec_check_pdo_regs(lcec_slave_t *slave, ec_pdo_entry_reg_t *pdo_entry_regs, int pdo_entry_count);
+static lcec_domain_t *lcec_find_domain(lcec_master_t *master, const char *name);
+static lcec_domain_t *lcec_pdo_reg_domain(lcec_slave_t *slave, ec_pdo_entry_reg_t *reg);
+static ec_direction_t lcec_pdo_reg_dir(lcec_slave_t *slave, ec_pdo_entry_reg_t *reg);
+static int lcec_register_domains(lcec_master_t *master);
+static int lcec_map_domains(lcec_master_t *master);
+static int lcec_build_rt_tables(lcec_master_t *master);
+static int lcec_init_slow_data(lcec_master_t *master);
+static inline int lcec_slave_needs_serial(lcec_slave_t *slave);
+static int lcec_init_slaves(void);
+static int lcec_fill_call_table(lcec_master_t *master, lcec_slave_call_t *calls, int write, int low_priority, int *noncrit_first);
+static int lcec_init_driver_workers(lcec_master_t *master);
+static void lcec_stop_threads(lcec_master_t *master);
+static int lcec_split_call_table(lcec_slave_call_t *calls, int count, lcec_call_chunk_t *chunks, int chunk_count, int write);
+static uint32_t lcec_estimate_frame_time(lcec_master_t *master);
+static void lcec_apply_sync0_shift(lcec_master_t *master, uint32_t send_offset, int msg_level);
+static void lcec_sync0_shift_task(void *arg);
+static void lcec_slow_apply(lcec_master_t *master);
 
 void lcec_read_all(void *arg, long period);
 void lcec_write_all(void *arg, long period);
+void lcec_cycle_all(void *arg, long period);
 void lcec_read_master(void *arg, long period);
 void lcec_write_master(void *arg, long period);
+void lcec_cycle_master(void *arg, long period);
+void lcec_read_slow_master(void *arg, long period);
+void lcec_write_slow_master(void *arg, long period);
+void lcec_send_inputs_master(void *arg, long period);
 
 /// @brief Main entrypoint from LinuxCNC
 int rtapi_app_main(void) {
   int slave_count;
   lcec_master_t *master;
   lcec_slave_t *slave;
+  lcec_domain_t *domain;
   char name[HAL_NAME_LEN + 1];
   ec_pdo_entry_reg_t *pdo_entry_regs;
-  lcec_slave_sdoconf_t *sdo_config;
-  lcec_slave_idnconf_t *idn_config;
   struct timeval tv;
+  int sweep_cycles;
+
+  startup.start = rtapi_get_time();
+  startup.last = startup.start;
 
   // connect to the HAL
   if ((lcec_comp_id = hal_init(LCEC_MODULE_NAME)) < 0) {
@@ -117,6 +194,7 @@ int rtapi_app_main(void) {
   if ((slave_count = lcec_parse_config()) < 0) {
     goto fail1;
   }
+  lcec_startup_mark(&startup, LCEC_STARTUP_PARSE);
 
   // init global hal data
   if ((global_hal_data = lcec_init_master_hal(LCEC_MODULE_NAME, 1)) == NULL) {
@@ -136,68 +214,36 @@ int rtapi_app_main(void) {
     ecrt_master_callbacks(master->master, lcec_request_lock, lcec_release_lock, master);
 #endif
 
-    // create domain
-    if (!(master->domain = ecrt_master_create_domain(master->master))) {
-      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s domain creation failed\n", master->name);
-      goto fail2;
+    // create domains
+    for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+      if (!(domain->domain = ecrt_master_create_domain(master->master))) {
+        rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s domain %s creation failed\n", master->name, domain->name);
+        goto fail2;
+      }
     }
 
-    // initialize slaves
+    // read slave configs
     pdo_entry_regs = master->pdo_entry_regs;
     for (slave = master->first_slave; slave != NULL; slave = slave->next) {
-      // read slave config
-
       rtapi_print_msg(RTAPI_MSG_DBG, LCEC_MSG_PFX "calling ecrt_master_slave_config for slave %s.%s\n", master->name, slave->name);
       if (!(slave->config = ecrt_master_slave_config(master->master, 0, slave->index, slave->vid, slave->pid))) {
         rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "fail to read slave %s.%s configuration\n", master->name, slave->name);
         goto fail2;
       }
-
-      // initialize sdos
-      if (slave->sdo_config != NULL) {
-        for (sdo_config = slave->sdo_config; sdo_config->index != 0xffff;
-             sdo_config = (lcec_slave_sdoconf_t *)&sdo_config->data[sdo_config->length]) {
-          if (sdo_config->subindex == LCEC_CONF_SDO_COMPLETE_SUBIDX) {
-            if (ecrt_slave_config_complete_sdo(slave->config, sdo_config->index, &sdo_config->data[0], sdo_config->length) != 0) {
-              rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failed to configure slave %s.%s sdo %04x (complete)\n", master->name,
-                  slave->name, sdo_config->index);
-            }
-          } else {
-            if (lcec_write_sdo(slave, sdo_config->index, sdo_config->subindex, &sdo_config->data[0], sdo_config->length) != 0) {
-              rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failed to configure slave %s.%s sdo %04x:%02x\n", master->name, slave->name,
-                  sdo_config->index, sdo_config->subindex);
-            }
-          }
-        }
-      }
-
-      // initialize idns
-      if (slave->idn_config != NULL) {
-        for (idn_config = slave->idn_config; idn_config->state != 0;
-             idn_config = (lcec_slave_idnconf_t *)&idn_config->data[idn_config->length]) {
-          if (ecrt_slave_config_idn(
-                  slave->config, idn_config->drive, idn_config->idn, idn_config->state, &idn_config->data[0], idn_config->length) != 0) {
-            rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "fail to configure slave %s.%s drive %d idn %c-%d-%d (state %d, length %u)\n",
-                master->name, slave->name, idn_config->drive, (idn_config->idn & 0x8000) ? 'P' : 'S', (idn_config->idn >> 12) & 0x0007,
-                idn_config->idn & 0x0fff, idn_config->state, (unsigned int)idn_config->length);
-          }
-        }
-      }
-
-      // setup pdos
-      if (slave->proc_init != NULL) {
-        rtapi_print_msg(RTAPI_MSG_DBG, LCEC_MSG_PFX "proc_init for slave %s.%s\n", master->name, slave->name);
-        if ((slave->proc_init(lcec_comp_id, slave, pdo_entry_regs)) != 0) {
-          rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failure in proc_init for slave %s.%s\n", master->name, slave->name);
-          goto fail2;
-        }
-      }
-      if (lcec_check_pdo_regs(slave, pdo_entry_regs, slave->pdo_entry_count) != 0) {
-        rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "PDO reg check failure for slave %s.%s\n", master->name, slave->name);
-        goto fail2;
-      }
+      slave->pdo_entry_regs = pdo_entry_regs;
       pdo_entry_regs += slave->pdo_entry_count;
+    }
+  }
+  lcec_startup_mark(&startup, LCEC_STARTUP_REQUEST);
+
+  // initialize slaves, this is where the blocking SDO transfers happen
+  if (lcec_init_slaves() != 0) {
+    goto fail2;
+  }
+  lcec_startup_mark(&startup, LCEC_STARTUP_SLAVES);
 
+  for (master = first_master; master != NULL; master = master->next) {
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
       // configure dc for this slave
       if (slave->dc_conf != NULL) {
         ecrt_slave_config_dc(slave->config, slave->dc_conf->assignActivate, slave->dc_conf->sync0Cycle, slave->dc_conf->sync0Shift,
@@ -228,22 +274,33 @@ int rtapi_app_main(void) {
         rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failure to export slave pins for slave %s.%s\n", master->name, slave->name);
         goto fail2;
       }
+
+      // export profiling params
+      if (master->profile_slaves) {
+        if (lcec_profile_init_hal(slave) != 0) {
+          rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failure to export profiling params for slave %s.%s\n", master->name, slave->name);
+          goto fail2;
+        }
+      }
     }
 
+    lcec_startup_mark(&startup, LCEC_STARTUP_SETUP);
+
     // terminate POD entries
-    pdo_entry_regs->index = 0;
+    master->pdo_entry_regs[master->pdo_entry_count].index = 0;
 
     // register PDO entries
     rtapi_print_msg(RTAPI_MSG_DBG, LCEC_MSG_PFX "register PDO entries\n");
-    if (ecrt_domain_reg_pdo_entry_list(master->domain, master->pdo_entry_regs)) {
-      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s PDO entry registration failed\n", master->name);
+    if (lcec_register_domains(master) != 0) {
       goto fail2;
     }
+    lcec_startup_mark(&startup, LCEC_STARTUP_REGISTER);
 
     // initialize application time
     rtapi_print_msg(RTAPI_MSG_DBG, LCEC_MSG_PFX "Setting time\n");
     lcec_gettimeofday(&tv);
     master->app_time_base = EC_TIMEVAL2NANO(tv);
+    master->app_time_start = master->app_time_base;
     ecrt_master_application_time(master->master, master->app_time_base);
 #ifdef RTAPI_TASK_PLL_SUPPORT
     master->dc_time_valid_last = 0;
@@ -258,6 +315,13 @@ int rtapi_app_main(void) {
     }
 #endif
 
+    // configure sync0Shift="auto" slaves with the estimated frame time.  With sendOffset the send
+    // phase is already known, otherwise assume the cycle start until the send time is measured.
+    if (master->sync0_shift_auto) {
+      master->frame_time = lcec_estimate_frame_time(master);
+      lcec_apply_sync0_shift(master, (master->send_offset >= 0) ? master->send_offset : 0, RTAPI_MSG_DBG);
+    }
+
     // activating master
     rtapi_print_msg(RTAPI_MSG_DBG, LCEC_MSG_PFX "Activating master\n");
     if (ecrt_master_activate(master->master)) {
@@ -265,9 +329,11 @@ int rtapi_app_main(void) {
       goto fail2;
     }
 
-    // Get internal process data for domain
-    master->process_data = ecrt_domain_data(master->domain);
-    master->process_data_len = ecrt_domain_size(master->domain);
+    // Get internal process data for domains
+    if (lcec_map_domains(master) != 0) {
+      goto fail2;
+    }
+    lcec_startup_mark(&startup, LCEC_STARTUP_ACTIVATE);
 
     // init hal data
     rtapi_snprintf(name, HAL_NAME_LEN, "%s.%s", LCEC_MODULE_NAME, master->name);
@@ -275,13 +341,81 @@ int rtapi_app_main(void) {
       rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failure to init hal pins for slave %s.%s\n", master->name, slave->name);
       goto fail2;
     }
+    *(master->hal_data->sync0_frame_time) = master->frame_time;
+
+    // init domain hal data
+    for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+      if ((domain->hal_data = lcec_init_domain_hal(master->name, domain->name)) == NULL) {
+        rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failure to init hal pins for domain %s.%s\n", master->name, domain->name);
+        goto fail2;
+      }
+    }
+
+    // build flattened slave tables for the RT functions
+    if (lcec_build_rt_tables(master) != 0) {
+      goto fail2;
+    }
+    if (lcec_init_slow_data(master) != 0) {
+      goto fail2;
+    }
+
+    // start the task applying the measured sync0Shift="auto" values, the cycle must not block on the master
+    if (master->sync0_shift_auto) {
+      if ((master->sync0_task = lcec_deferred_start(master->name, lcec_sync0_shift_task, master)) == NULL) {
+        rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "master %s: measured sync0Shift=\"auto\" values will only be exported as pins\n",
+            master->name);
+      }
+    }
+
+    // start driver worker threads
+    if (master->driver_cpus != 0) {
+      if (master->cycle_budget > 0) {
+        rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "cycleBudget for master %s ignored, not supported with driverCpus\n", master->name);
+        master->cycle_budget = 0;
+      }
+      if (lcec_init_driver_workers(master) != 0) {
+        goto fail2;
+      }
+    }
+
+    // start bus thread, from here on it exchanges the process data
+    if (master->bus_cycle_multiplier > 1) {
+      if (master->app_time_period % master->bus_cycle_multiplier != 0) {
+        rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "master %s: appTimePeriod is not a multiple of busCycleMultiplier, using %u ns\n",
+            master->name, master->bus_period);
+      }
+      if (lcec_bus_start(master) != 0) {
+        goto fail2;
+      }
+    }
+
+    // check that a staggered slave state sweep fits into the state update period
+    if (master->state_update_slaves > 0) {
+      sweep_cycles = (master->slave_count + master->state_update_slaves - 1) / master->state_update_slaves;
+      if ((long long)sweep_cycles * master->app_time_period > master->state_update_period) {
+        rtapi_print_msg(RTAPI_MSG_WARN,
+            LCEC_MSG_PFX "master %s: polling %d slave states per cycle takes longer than stateUpdatePeriod, states will update less often\n",
+            master->name, master->state_update_slaves);
+      }
+    }
 
 #ifdef RTAPI_TASK_PLL_SUPPORT
     // set default PLL_STEP: use +/-0.1% of period
     master->hal_data->pll_step = master->app_time_period / 1000;
     // set default PLL_MAX_ERR: one period
     master->hal_data->pll_max_err = master->app_time_period;
+    // set default PI gains
+    master->hal_data->pll_p_gain = LCEC_PLL_DEFAULT_P_GAIN;
+    master->hal_data->pll_i_gain = LCEC_PLL_DEFAULT_I_GAIN;
+    // set default PLL_LOCK_WINDOW: 0.1% of period
+    master->hal_data->pll_lock_window = master->app_time_period / 1000;
 #endif
+    // set default timing histogram bucket width: 1% of period
+    master->hal_data->timing_hist_width = master->app_time_period / 100;
+    // set default DC statistics: windows of 1000 samples, 1% of period allowed error
+    master->hal_data->dc_stats.window = 1000;
+    master->hal_data->dc_stats.sync_window = master->app_time_period / 100;
+    master->hal_data->dc_stats.sample_cycles = 10;
 
     // export read function
     rtapi_snprintf(name, HAL_NAME_LEN, "%s.%s.read", LCEC_MODULE_NAME, master->name);
@@ -295,6 +429,51 @@ int rtapi_app_main(void) {
       rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s write funct export failed\n", master->name);
       goto fail2;
     }
+    // export combined read/write function
+    rtapi_snprintf(name, HAL_NAME_LEN, "%s.%s.cycle", LCEC_MODULE_NAME, master->name);
+    if (hal_export_funct(name, lcec_cycle_master, master, 0, 0, lcec_comp_id) != 0) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s cycle funct export failed\n", master->name);
+      goto fail2;
+    }
+    // export slow read function
+    rtapi_snprintf(name, HAL_NAME_LEN, "%s.%s.read-slow", LCEC_MODULE_NAME, master->name);
+    if (hal_export_funct(name, lcec_read_slow_master, master, 0, 0, lcec_comp_id) != 0) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s read-slow funct export failed\n", master->name);
+      goto fail2;
+    }
+    // export slow write function
+    rtapi_snprintf(name, HAL_NAME_LEN, "%s.%s.write-slow", LCEC_MODULE_NAME, master->name);
+    if (hal_export_funct(name, lcec_write_slow_master, master, 0, 0, lcec_comp_id) != 0) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s write-slow funct export failed\n", master->name);
+      goto fail2;
+    }
+    // export input domain send function
+    if (master->input_domain != NULL) {
+      rtapi_snprintf(name, HAL_NAME_LEN, "%s.%s.send-inputs", LCEC_MODULE_NAME, master->name);
+      if (hal_export_funct(name, lcec_send_inputs_master, master, 0, 0, lcec_comp_id) != 0) {
+        rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s send-inputs funct export failed\n", master->name);
+        goto fail2;
+      }
+    }
+
+    // start worker thread for read-all/write-all
+    if (master->worker_cpus != 0) {
+      if ((master->worker = lcec_worker_start(master->name, master->worker_cpus)) == NULL) {
+        goto fail2;
+      }
+#ifdef RTAPI_TASK_PLL_SUPPORT
+      if (master->sync_ref_cycles < 0) {
+        rtapi_print_msg(RTAPI_MSG_INFO,
+            LCEC_MSG_PFX "master %s syncs the HAL thread to the reference clock, write-all runs it in the HAL thread\n", master->name);
+      }
+#endif
+    }
+    lcec_startup_mark(&startup, LCEC_STARTUP_HAL);
+  }
+
+  // setup profiling shared memory for lcec_top
+  if (lcec_profile_init_shmem(first_master) != 0) {
+    goto fail2;
   }
 
   // export read-all function
@@ -309,6 +488,17 @@ int rtapi_app_main(void) {
     rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "write-all funct export failed\n");
     goto fail2;
   }
+  // export cycle-all function
+  rtapi_snprintf(name, HAL_NAME_LEN, "%s.cycle-all", LCEC_MODULE_NAME);
+  if (hal_export_funct(name, lcec_cycle_all, NULL, 0, 0, lcec_comp_id) != 0) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "cycle-all funct export failed\n");
+    goto fail2;
+  }
+
+  // report the startup timeline, the report is written again on exit with the time until OP
+  lcec_startup_mark(&startup, LCEC_STARTUP_HAL);
+  lcec_startup_print(&startup, first_master);
+  lcec_startup_write(&startup, first_master);
 
   rtapi_print_msg(RTAPI_MSG_INFO, LCEC_MSG_PFX "installed driver for %d slaves\n", slave_count);
   hal_ready(lcec_comp_id);
@@ -325,15 +515,44 @@ fail0:
   return -EINVAL;
 }
 
+/// @brief Stop the threads working on a master: bus thread, workers and the sync0Shift task.
+///
+/// Safe to call more than once, stopped threads are cleared.
+static void lcec_stop_threads(lcec_master_t *master) {
+  int i;
+
+  if (master->bus != NULL) {
+    lcec_bus_stop(master);
+  }
+  if (master->worker != NULL) {
+    lcec_worker_stop(master->worker);
+    master->worker = NULL;
+  }
+  if (master->sync0_task != NULL) {
+    lcec_deferred_stop(master->sync0_task);
+    master->sync0_task = NULL;
+  }
+  if (master->driver_workers != NULL) {
+    for (i = 0; i < master->driver_worker_count; i++) {
+      if (master->driver_workers[i] != NULL) {
+        lcec_worker_stop(master->driver_workers[i]);
+        master->driver_workers[i] = NULL;
+      }
+    }
+  }
+}
+
 /// @brief Shut down LinuxCNC-Ethercat
 void rtapi_app_exit(void) {
   lcec_master_t *master;
 
-  // deactivate all masters
+  // deactivate all masters, nothing may use their slave configs afterwards
   for (master = first_master; master != NULL; master = master->next) {
+    lcec_stop_threads(master);
     ecrt_master_deactivate(master->master);
   }
 
+  lcec_startup_write(&startup, first_master);
   lcec_clear_config();
   hal_exit(lcec_comp_id);
 }
@@ -349,11 +568,14 @@ int lcec_parse_config(void) {
   const lcec_typelist_t *type;
   lcec_master_t *master;
   lcec_slave_t *slave;
+  lcec_domain_t *domain;
   lcec_slave_dc_t *dc;
   lcec_slave_watchdog_t *wd;
   ec_pdo_entry_reg_t *pdo_entry_regs;
   LCEC_CONF_TYPE_T conf_type;
+  LCEC_CONF_MASTERS_T *masters_conf;
   LCEC_CONF_MASTER_T *master_conf;
+  LCEC_CONF_DOMAIN_T *domain_conf;
   LCEC_CONF_SLAVE_T *slave_conf;
   LCEC_CONF_DC_T *dc_conf;
   LCEC_CONF_WATCHDOG_T *wd_conf;
@@ -376,6 +598,7 @@ int lcec_parse_config(void) {
   // initialize list
   first_master = NULL;
   last_master = NULL;
+  lcec_arena_init(&config_arena, 0);
 
   // try to get config header
   shmem_id = rtapi_shmem_new(LCEC_CONF_SHMEM_KEY, lcec_comp_id, sizeof(LCEC_CONF_HEADER_T));
@@ -427,13 +650,22 @@ int lcec_parse_config(void) {
   while ((conf_type = ((LCEC_CONF_NULL_T *)conf)->confType) != lcecConfTypeNone) {
     // get type
     switch (conf_type) {
+      case lcecConfTypeMasters:
+        // get config token
+        masters_conf = (LCEC_CONF_MASTERS_T *)conf;
+        conf += sizeof(LCEC_CONF_MASTERS_T);
+
+        strncpy(startup.report, masters_conf->startupReport, LCEC_CONF_PATH_MAXLEN);
+        startup.report[LCEC_CONF_PATH_MAXLEN - 1] = 0;
+        break;
+
       case lcecConfTypeMaster:
         // get config token
         master_conf = (LCEC_CONF_MASTER_T *)conf;
         conf += sizeof(LCEC_CONF_MASTER_T);
 
         // alloc master memory
-        master = lcec_zalloc(sizeof(lcec_master_t));
+        master = lcec_arena_zalloc(&config_arena, sizeof(lcec_master_t));
         if (master == NULL) {
           rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %d structure memory\n", master_conf->index);
           goto fail2;
@@ -445,9 +677,125 @@ int lcec_parse_config(void) {
         master->name[LCEC_CONF_STR_MAXLEN - 1] = 0;
         master->app_time_period = master_conf->appTimePeriod;
         master->sync_ref_cycles = master_conf->refClockSyncCycles;
+        master->profile_slaves = master_conf->profileSlaves;
+        master->wc_policy = master_conf->wcPolicy;
+#ifdef RTAPI_TASK_PLL_SUPPORT
+        master->pll_mode = master_conf->pllMode;
+#endif
+        master->state_update_period = master_conf->stateUpdatePeriod;
+        master->state_update_slaves = master_conf->stateUpdateSlaves;
+        master->state_update_next = -1;
+        master->sync0_shift_cycles = master_conf->sync0ShiftCycles;
+        master->cycle_budget = (long long)master->app_time_period * master_conf->cycleBudget / 100;
+        master->init_threads = master_conf->initThreads;
+        master->send_offset = master_conf->sendOffset;
+        if (master->send_offset >= 0 && (uint32_t)master->send_offset >= master->app_time_period) {
+          rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s: sendOffset must be shorter than appTimePeriod\n", master->name);
+          goto fail2;
+        }
+        master->bus_cycle_multiplier = 1;
+        master->bus_interp = master_conf->busInterpolation;
+        master->bus_feedback = master_conf->busFeedback;
+#ifdef __KERNEL__
+        if (master_conf->exclusive) {
+          rtapi_print_msg(RTAPI_MSG_WARN,
+              LCEC_MSG_PFX "exclusive mode for master %s ignored, the kernel master may call back from other contexts\n", master->name);
+        }
+        if (master_conf->workerCpus != 0) {
+          rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "workerCpus for master %s ignored, not supported in kernel mode\n", master->name);
+        }
+        if (master_conf->driverCpus != 0) {
+          rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "driverCpus for master %s ignored, not supported in kernel mode\n", master->name);
+        }
+        if (master_conf->busCycleMultiplier > 1) {
+          rtapi_print_msg(
+              RTAPI_MSG_WARN, LCEC_MSG_PFX "busCycleMultiplier for master %s ignored, not supported in kernel mode\n", master->name);
+        }
+#else
+        master->exclusive = master_conf->exclusive;
+        master->worker_cpus = master_conf->workerCpus;
+        master->driver_cpus = master_conf->driverCpus;
+        master->bus_cycle_multiplier = master_conf->busCycleMultiplier;
+        master->bus_cpus = master_conf->busCpus;
+#endif
+        master->bus_period = master->app_time_period / master->bus_cycle_multiplier;
+        if (master->bus_cycle_multiplier > 1) {
+          if (master->sync_ref_cycles < 0) {
+            rtapi_print_msg(RTAPI_MSG_ERR,
+                LCEC_MSG_PFX "master %s: busCycleMultiplier can't be used with a negative refClockSyncCycles\n", master->name);
+            goto fail2;
+          }
+          if (master->exclusive) {
+            rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "exclusive mode for master %s ignored, the bus thread shares the master\n",
+                master->name);
+            master->exclusive = 0;
+          }
+          if (master->send_offset >= 0) {
+            rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "sendOffset for master %s ignored, the bus thread sends on its own timer\n",
+                master->name);
+            master->send_offset = -1;
+          }
+        }
 
         // add master to list
         LCEC_LIST_APPEND(first_master, last_master, master);
+
+        // alloc default domain
+        domain = lcec_arena_zalloc(&config_arena, sizeof(lcec_domain_t));
+        if (domain == NULL) {
+          rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s domain memory\n", master->name);
+          goto fail2;
+        }
+        strncpy(domain->name, LCEC_DEFAULT_DOMAIN_NAME, LCEC_CONF_STR_MAXLEN);
+        domain->cycle_divisor = 1;
+        LCEC_LIST_APPEND(master->first_domain, master->last_domain, domain);
+
+        // alloc input domain
+        if (master_conf->splitDomains) {
+          domain = lcec_arena_zalloc(&config_arena, sizeof(lcec_domain_t));
+          if (domain == NULL) {
+            rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s domain memory\n", master->name);
+            goto fail2;
+          }
+          strncpy(domain->name, LCEC_INPUT_DOMAIN_NAME, LCEC_CONF_STR_MAXLEN);
+          domain->cycle_divisor = 1;
+          LCEC_LIST_APPEND(master->first_domain, master->last_domain, domain);
+          master->input_domain = domain;
+        }
+        break;
+
+      case lcecConfTypeDomain:
+        // get config token
+        domain_conf = (LCEC_CONF_DOMAIN_T *)conf;
+        conf += sizeof(LCEC_CONF_DOMAIN_T);
+
+        // check for master
+        if (master == NULL) {
+          rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Master node for domain missing\n");
+          goto fail2;
+        }
+
+        // the default and input domains may be redefined, but no other
+        domain = lcec_find_domain(master, domain_conf->name);
+        if (domain != NULL && domain != master->first_domain && domain != master->input_domain) {
+          rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Duplicate domain %s.%s\n", master->name, domain_conf->name);
+          goto fail2;
+        }
+
+        // alloc domain memory
+        if (domain == NULL) {
+          domain = lcec_arena_zalloc(&config_arena, sizeof(lcec_domain_t));
+          if (domain == NULL) {
+            rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate domain %s.%s memory\n", master->name, domain_conf->name);
+            goto fail2;
+          }
+          strncpy(domain->name, domain_conf->name, LCEC_CONF_STR_MAXLEN);
+          domain->name[LCEC_CONF_STR_MAXLEN - 1] = 0;
+          LCEC_LIST_APPEND(master->first_domain, master->last_domain, domain);
+        }
+
+        // initialize domain
+        domain->cycle_divisor = domain_conf->cycleDivisor;
         break;
 
       case lcecConfTypeSlave:
@@ -474,7 +822,7 @@ int lcec_parse_config(void) {
         }
 
         // create new slave
-        slave = lcec_zalloc(sizeof(lcec_slave_t));
+        slave = lcec_arena_zalloc(&config_arena, sizeof(lcec_slave_t));
         if (slave == NULL) {
           rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unabl eto allocate slave %s.%s structure memory\n", master->name, slave_conf->name);
           goto fail2;
@@ -493,11 +841,23 @@ int lcec_parse_config(void) {
         slave->index = slave_conf->index;
         strncpy(slave->name, slave_conf->name, LCEC_CONF_STR_MAXLEN);
         slave->name[LCEC_CONF_STR_MAXLEN - 1] = 0;
+        strncpy(slave->type_name, slave_conf->typename, LCEC_CONF_STR_MAXLEN);
+        slave->type_name[LCEC_CONF_STR_MAXLEN - 1] = 0;
         slave->master = master;
+        slave->low_priority = slave_conf->lowPriority;
+        slave->non_critical = slave_conf->nonCritical;
 
         // add slave to list
         LCEC_LIST_APPEND(master->first_slave, master->last_slave, slave);
 
+        // assign domain
+        if (slave_conf->domain[0] == 0) {
+          slave->domain = master->first_domain;
+        } else if ((slave->domain = lcec_find_domain(master, slave_conf->domain)) == NULL) {
+          rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unknown domain %s for slave %s.%s\n", slave_conf->domain, master->name, slave->name);
+          goto fail2;
+        }
+
         if (type != NULL) {
           // normal slave
           slave->vid = type->vid;
@@ -522,7 +882,7 @@ int lcec_parse_config(void) {
           memset(generic_hal_data, 0, sizeof(lcec_generic_pin_t) * slave_conf->pdoMappingCount);
 
           // alloc pdo entry memory
-          generic_pdo_entries = lcec_zalloc(sizeof(ec_pdo_entry_info_t) * slave_conf->pdoEntryCount);
+          generic_pdo_entries = lcec_arena_zalloc(&config_arena, sizeof(ec_pdo_entry_info_t) * slave_conf->pdoEntryCount);
           if (generic_pdo_entries == NULL) {
             rtapi_print_msg(
                 RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s generic pdo entry memory\n", master->name, slave_conf->name);
@@ -530,21 +890,18 @@ int lcec_parse_config(void) {
           }
 
           // alloc pdo memory
-          generic_pdos = lcec_zalloc(sizeof(ec_pdo_info_t) * slave_conf->pdoCount);
+          generic_pdos = lcec_arena_zalloc(&config_arena, sizeof(ec_pdo_info_t) * slave_conf->pdoCount);
           if (generic_pdos == NULL) {
             rtapi_print_msg(
                 RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s generic pdo memory\n", master->name, slave_conf->name);
-            lcec_free(generic_pdo_entries);
             goto fail2;
           }
 
           // alloc sync manager memory
-          generic_sync_managers = lcec_zalloc(sizeof(ec_sync_info_t) * (slave_conf->syncManagerCount + 1));
+          generic_sync_managers = lcec_arena_zalloc(&config_arena, sizeof(ec_sync_info_t) * (slave_conf->syncManagerCount + 1));
           if (generic_sync_managers == NULL) {
             rtapi_print_msg(
                 RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s generic sync manager memory\n", master->name, slave_conf->name);
-            lcec_free(generic_pdo_entries);
-            lcec_free(generic_pdos);
             goto fail2;
           }
           generic_sync_managers->index = 0xff;
@@ -552,41 +909,29 @@ int lcec_parse_config(void) {
 
         // alloc sdo config memory
         if (slave_conf->sdoConfigLength > 0) {
-          sdo_config = lcec_zalloc(slave_conf->sdoConfigLength + sizeof(lcec_slave_sdoconf_t));
+          sdo_config = lcec_arena_zalloc(&config_arena, slave_conf->sdoConfigLength + sizeof(lcec_slave_sdoconf_t));
           if (sdo_config == NULL) {
             rtapi_print_msg(
                 RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s sdo entry memory\n", master->name, slave_conf->name);
-            lcec_free(generic_pdo_entries);
-            lcec_free(generic_pdos);
-            lcec_free(generic_sync_managers);
             goto fail2;
           }
         }
 
         // alloc idn config memory
         if (slave_conf->idnConfigLength > 0) {
-          idn_config = lcec_zalloc(slave_conf->idnConfigLength + sizeof(lcec_slave_idnconf_t));
+          idn_config = lcec_arena_zalloc(&config_arena, slave_conf->idnConfigLength + sizeof(lcec_slave_idnconf_t));
           if (idn_config == NULL) {
             rtapi_print_msg(
                 RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s idn entry memory\n", master->name, slave_conf->name);
-            lcec_free(generic_pdo_entries);
-            lcec_free(generic_pdos);
-            lcec_free(generic_sync_managers);
-            lcec_free(sdo_config);
             goto fail2;
           }
         }
 
         // alloc modparam memory
         if (slave_conf->modParamCount > 0) {
-          modparams = lcec_zalloc(sizeof(lcec_slave_modparam_t) * (slave_conf->modParamCount + 1));
+          modparams = lcec_arena_zalloc(&config_arena, sizeof(lcec_slave_modparam_t) * (slave_conf->modParamCount + 1));
           if (modparams == NULL) {
             rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s modparam memory\n", master->name, slave_conf->name);
-            lcec_free(generic_pdo_entries);
-            lcec_free(generic_pdos);
-            lcec_free(generic_sync_managers);
-            lcec_free(sdo_config);
-            lcec_free(idn_config);
             goto fail2;
           }
           modparams[slave_conf->modParamCount].id = -1;
@@ -627,7 +972,7 @@ int lcec_parse_config(void) {
         }
 
         // create new dc config
-        dc = lcec_zalloc(sizeof(lcec_slave_dc_t));
+        dc = lcec_arena_zalloc(&config_arena, sizeof(lcec_slave_dc_t));
         if (dc == NULL) {
           rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s dc config memory\n", master->name, slave->name);
           goto fail2;
@@ -639,6 +984,11 @@ int lcec_parse_config(void) {
         dc->sync0Shift = dc_conf->sync0Shift;
         dc->sync1Cycle = dc_conf->sync1Cycle;
         dc->sync1Shift = dc_conf->sync1Shift;
+        dc->sync0ShiftAuto = dc_conf->sync0ShiftAuto;
+        dc->sync0ShiftMargin = dc_conf->sync0ShiftMargin;
+        if (dc->sync0ShiftAuto) {
+          master->sync0_shift_auto = 1;
+        }
 
         // add to slave
         slave->dc_conf = dc;
@@ -662,7 +1012,7 @@ int lcec_parse_config(void) {
         }
 
         // create new wd config
-        wd = lcec_zalloc(sizeof(lcec_slave_watchdog_t));
+        wd = lcec_arena_zalloc(&config_arena, sizeof(lcec_slave_watchdog_t));
         if (wd == NULL) {
           rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s watchdog config memory\n", master->name, slave->name);
           goto fail2;
@@ -693,6 +1043,22 @@ int lcec_parse_config(void) {
           goto fail2;
         }
 
+        // assign domain override
+        if (sm_conf->domain[0] != 0) {
+          if (slave->sm_domains == NULL) {
+            slave->sm_domains = lcec_arena_zalloc(&config_arena, sizeof(lcec_domain_t *) * EC_MAX_SYNC_MANAGERS);
+            if (slave->sm_domains == NULL) {
+              rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s domain memory\n", master->name, slave->name);
+              goto fail2;
+            }
+          }
+          if ((slave->sm_domains[sm_conf->index] = lcec_find_domain(master, sm_conf->domain)) == NULL) {
+            rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unknown domain %s for slave %s.%s syncManager %d\n", sm_conf->domain, master->name,
+                slave->name, sm_conf->index);
+            goto fail2;
+          }
+        }
+
         // initialize sync manager
         generic_sync_managers->index = sm_conf->index;
         generic_sync_managers->dir = sm_conf->dir;
@@ -921,13 +1287,22 @@ int lcec_parse_config(void) {
       }
     }
 
+    // FSoE data is copied between slaves, so they must all see the same process data
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+      if (slave->low_priority && lcec_slave_needs_serial(slave)) {
+        rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "priority=\"low\" for slave %s.%s ignored, safety slaves run in the fast thread\n",
+            master->name, slave->name);
+        slave->low_priority = 0;
+      }
+    }
+
     // stage 3 preinit: sum required pdo mappings
     for (slave = master->first_slave; slave != NULL; slave = slave->next) {
       master->pdo_entry_count += slave->pdo_entry_count;
     }
 
     // alloc mem for pdo mappings
-    pdo_entry_regs = lcec_zalloc(sizeof(ec_pdo_entry_reg_t) * (master->pdo_entry_count + 2));
+    pdo_entry_regs = lcec_arena_zalloc(&config_arena, sizeof(ec_pdo_entry_reg_t) * (master->pdo_entry_count + 2));
     if (pdo_entry_regs == NULL) {
       rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s PDO entry memory\n", master->name);
       goto fail2;
@@ -949,12 +1324,28 @@ fail0:
 void lcec_clear_config(void) {
   lcec_master_t *master, *prev_master;
   lcec_slave_t *slave, *prev_slave;
+  lcec_domain_t *domain;
+
+  // release profiling shared memory
+  lcec_profile_exit_shmem();
 
   // iterate all masters
   master = last_master;
   while (master != NULL) {
     prev_master = master->prev;
 
+    // stop bus thread and workers
+    lcec_stop_threads(master);
+    if (master->driver_workers != NULL) {
+      lcec_free(master->driver_workers);
+    }
+    if (master->read_chunks != NULL) {
+      lcec_free(master->read_chunks);
+    }
+    if (master->write_chunks != NULL) {
+      lcec_free(master->write_chunks);
+    }
+
     // iterate all masters
     slave = master->last_slave;
     while (slave != NULL) {
@@ -965,32 +1356,6 @@ void lcec_clear_config(void) {
         slave->proc_cleanup(slave);
       }
 
-      // free slave
-      if (slave->modparams != NULL) {
-        lcec_free(slave->modparams);
-      }
-      if (slave->sdo_config != NULL) {
-        lcec_free(slave->sdo_config);
-      }
-      if (slave->idn_config != NULL) {
-        lcec_free(slave->idn_config);
-      }
-      if (slave->generic_pdo_entries != NULL) {
-        lcec_free(slave->generic_pdo_entries);
-      }
-      if (slave->generic_pdos != NULL) {
-        lcec_free(slave->generic_pdos);
-      }
-      if (slave->generic_sync_managers != NULL) {
-        lcec_free(slave->generic_sync_managers);
-      }
-      if (slave->dc_conf != NULL) {
-        lcec_free(slave->dc_conf);
-      }
-      if (slave->wd_conf != NULL) {
-        lcec_free(slave->wd_conf);
-      }
-      lcec_free(slave);
       slave = prev_slave;
     }
 
@@ -999,15 +1364,109 @@ void lcec_clear_config(void) {
       ecrt_release_master(master->master);
     }
 
-    // free PDO entry memory
-    if (master->pdo_entry_regs != NULL) {
-      lcec_free(master->pdo_entry_regs);
+    // free process data memory
+    if (master->process_data_mem != NULL) {
+      lcec_free(master->process_data_mem);
+    }
+
+    // free RT tables
+    if (master->rt_tables != NULL) {
+      lcec_free(master->rt_tables);
+    }
+
+    // free the low priority slaves' process data
+    if (master->slow_data != NULL) {
+      lcec_free(master->slow_data);
+    }
+
+    // free domain PDO entry memory
+    for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+      if (domain->pdo_entry_regs != NULL) {
+        lcec_free(domain->pdo_entry_regs);
+      }
     }
 
-    // free master
-    lcec_free(master);
     master = prev_master;
   }
+
+  // free masters, domains and slaves with everything parsed from the config
+  lcec_arena_free(&config_arena);
+  first_master = NULL;
+  last_master = NULL;
+}
+
+/// @brief Take the master's lock for a cycle phase, unless the master is in exclusive mode.
+static inline void lcec_master_lock(lcec_master_t *master) {
+  if (!master->exclusive) {
+    rtapi_mutex_get(&master->mutex);
+  }
+}
+
+/// @brief Release the master's lock, unless the master is in exclusive mode.
+static inline void lcec_master_unlock(lcec_master_t *master) {
+  if (!master->exclusive) {
+    rtapi_mutex_give(&master->mutex);
+  }
+}
+
+/// @brief Run the slave callbacks of a part of a callback table.
+static inline void lcec_run_calls(lcec_slave_call_t *call, lcec_slave_call_t *call_end, long period, int write) {
+  long long t_slave;
+
+  for (; call < call_end; call++) {
+    // hold the inputs of slaves whose domain was not exchanged completely, only set with wcPolicy="hold"
+    if (call->data_valid != NULL && !*call->data_valid) {
+      continue;
+    }
+
+    LCEC_TRACE3(slave_begin, call->slave->master->name, call->slave->name, write);
+    if (call->profile != NULL) {
+      t_slave = rtapi_get_time();
+      call->proc(call->slave, period);
+      lcec_profile_update(write ? &call->profile->write : &call->profile->read, rtapi_get_time() - t_slave);
+    } else {
+      call->proc(call->slave, period);
+    }
+    LCEC_TRACE3(slave_end, call->slave->master->name, call->slave->name, write);
+  }
+}
+
+/// @brief Set a pair of `-lo`/`-hi` pins to a 64-bit value.
+static inline void lcec_set_u64_pins(hal_u32_t *lo, hal_u32_t *hi, uint64_t val) {
+  *lo = (uint32_t)val;
+  *hi = (uint32_t)(val >> 32);
+}
+
+/// @brief Check if read and write have used up the master's cycle budget.
+/// @param used Time used by read and write so far.
+static inline int lcec_cycle_budget_exceeded(lcec_master_t *master, long long used) {
+  return master->cycle_budget > 0 && used > master->cycle_budget;
+}
+
+/// @brief Worker job running one chunk of a callback table.
+static void lcec_run_call_chunk(void *arg, long period) {
+  lcec_call_chunk_t *chunk = (lcec_call_chunk_t *)arg;
+
+  lcec_run_calls(chunk->first, chunk->end, period, chunk->write);
+}
+
+/// @brief Run a callback table on the driver workers and the calling thread.
+///
+/// The last chunk runs in the calling thread.  Calls from `serial_first`
+/// on run after all workers are done.
+static void lcec_run_calls_parallel(lcec_master_t *master, lcec_call_chunk_t *chunks, lcec_slave_call_t *calls, int serial_first, int count,
+    long period, int write) {
+  int i;
+
+  for (i = 0; i < master->driver_worker_count; i++) {
+    lcec_worker_run(master->driver_workers[i], lcec_run_call_chunk, &chunks[i], period);
+  }
+  lcec_run_call_chunk(&chunks[master->driver_worker_count], period);
+  for (i = 0; i < master->driver_worker_count; i++) {
+    lcec_worker_wait(master->driver_workers[i]);
+  }
+
+  lcec_run_calls(&calls[serial_first], &calls[count], period, write);
 }
 
 #ifdef __KERNEL__
@@ -1027,6 +1486,7 @@ static void lcec_release_lock(void *data) {
 /// @brief Initialize LinuxCNC HAL pins for the master device.
 lcec_master_data_t *lcec_init_master_hal(const char *pfx, int global) {
   lcec_master_data_t *hal_data;
+  int i;
 
   // alloc hal data
   if ((hal_data = hal_malloc(sizeof(lcec_master_data_t))) == NULL) {
@@ -1046,6 +1506,14 @@ lcec_master_data_t *lcec_init_master_hal(const char *pfx, int global) {
     if (lcec_param_newf_list(hal_data, master_params, pfx) != 0) {
       return NULL;
     }
+    for (i = 0; i < LCEC_TIMING_PHASE_COUNT; i++) {
+      if (lcec_timing_init_hal(&hal_data->timing[i], pfx, timing_phase_names[i]) != 0) {
+        return NULL;
+      }
+    }
+    if (lcec_dc_stats_init_hal(&hal_data->dc_stats, pfx) != 0) {
+      return NULL;
+    }
   }
 
   return hal_data;
@@ -1070,6 +1538,25 @@ lcec_slave_state_t *lcec_init_slave_state_hal(char *master_name, char *slave_nam
   return hal_data;
 }
 
+/// @brief Initialize LinuxCNC HAL pins for a process data domain.
+lcec_domain_data_t *lcec_init_domain_hal(char *master_name, char *domain_name) {
+  lcec_domain_data_t *hal_data;
+
+  // alloc hal data
+  if ((hal_data = hal_malloc(sizeof(lcec_domain_data_t))) == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "hal_malloc() for %s.%s.domain.%s failed\n", LCEC_MODULE_NAME, master_name, domain_name);
+    return NULL;
+  }
+  memset(hal_data, 0, sizeof(lcec_domain_data_t));
+
+  // export pins
+  if (lcec_pin_newf_list(hal_data, domain_pins, LCEC_MODULE_NAME, master_name, domain_name) != 0) {
+    return NULL;
+  }
+
+  return hal_data;
+}
+
 /// @brief Verify that the correct number of PDOs were added by the slave.
 /// @param pdo_entry_regs The PDOs for the driver.
 /// @param pdo_entry_count The number of expected PDOs.
@@ -1090,60 +1577,830 @@ static int lcec_check_pdo_regs(lcec_slave_t *slave, ec_pdo_entry_reg_t *pdo_entr
   return 0;
 }
 
-/// @brief Update HAL pins for the master.
-void lcec_update_master_hal(lcec_master_data_t *hal_data, ec_master_state_t *ms) {
-  *(hal_data->slaves_responding) = ms->slaves_responding;
-  *(hal_data->state_init) = (ms->al_states & 0x01) != 0;
-  *(hal_data->state_preop) = (ms->al_states & 0x02) != 0;
-  *(hal_data->state_safeop) = (ms->al_states & 0x04) != 0;
-  *(hal_data->state_op) = (ms->al_states & 0x08) != 0;
-  *(hal_data->link_up) = ms->link_up;
-  *(hal_data->all_op) = (ms->al_states == 0x08);
-}
+/// @brief Find a master's domain by name.
+/// @return The domain, or NULL if the master has no domain of that name.
+static lcec_domain_t *lcec_find_domain(lcec_master_t *master, const char *name) {
+  lcec_domain_t *domain;
 
-/// @brief Update generic HAL pins for a slave.
-void lcec_update_slave_state_hal(lcec_slave_state_t *hal_data, ec_slave_config_state_t *ss) {
-  *(hal_data->online) = ss->online;
-  *(hal_data->operational) = ss->operational;
-  *(hal_data->state_init) = (ss->al_state & 0x01) != 0;
-  *(hal_data->state_preop) = (ss->al_state & 0x02) != 0;
-  *(hal_data->state_safeop) = (ss->al_state & 0x04) != 0;
-  *(hal_data->state_op) = (ss->al_state & 0x08) != 0;
-}
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (strcmp(domain->name, name) == 0) {
+      return domain;
+    }
+  }
 
-/// @brief Update all input pins across all masters and slaves.
-void lcec_read_all(void *arg, long period) {
-  lcec_master_t *master;
+  return NULL;
+}
 
-  // initialize global state
+/// @brief Get the domain a PDO entry registration of a slave belongs to.
+///
+/// This is the slave's domain, unless the sync manager that maps the
+/// entry was assigned to a different domain.  Inputs of a split default
+/// domain go to the master's input domain.
+static lcec_domain_t *lcec_pdo_reg_domain(lcec_slave_t *slave, ec_pdo_entry_reg_t *reg) {
+  lcec_master_t *master = slave->master;
+  const ec_sync_info_t *sync;
+  const ec_pdo_info_t *pdo;
+  unsigned int i, j;
+
+  if (slave->sm_domains != NULL && slave->sync_info != NULL) {
+    for (sync = slave->sync_info; sync->index != 0xff; sync++) {
+      if (slave->sm_domains[sync->index] == NULL) {
+        continue;
+      }
+      for (i = 0, pdo = sync->pdos; i < sync->n_pdos; i++, pdo++) {
+        for (j = 0; j < pdo->n_entries; j++) {
+          if (pdo->entries[j].index == reg->index && pdo->entries[j].subindex == reg->subindex) {
+            return slave->sm_domains[sync->index];
+          }
+        }
+      }
+    }
+  }
+
+  if (slave->domain == master->first_domain && master->input_domain != NULL && lcec_pdo_reg_dir(slave, reg) == EC_DIR_INPUT) {
+    return master->input_domain;
+  }
+
+  return slave->domain;
+}
+
+/// @brief Get the direction of the sync manager mapping a PDO entry registration.
+///
+/// Uses the driver's sync manager configuration if it has one.
+/// Otherwise the slave uses its default mapping, which is asked from the
+/// master.
+/// @return The direction, or `EC_DIR_INVALID` if the entry wasn't found.
+static ec_direction_t lcec_pdo_reg_dir(lcec_slave_t *slave, ec_pdo_entry_reg_t *reg) {
+  ec_master_t *master = slave->master->master;
+  const ec_sync_info_t *sync;
+  const ec_pdo_info_t *pdo;
+  ec_slave_info_t slave_info;
+  ec_sync_info_t sync_info;
+  ec_pdo_info_t pdo_info;
+  ec_pdo_entry_info_t entry_info;
+  unsigned int i, j;
+  uint8_t sm;
+
+  // mapping configured by the driver
+  if (slave->sync_info != NULL) {
+    for (sync = slave->sync_info; sync->index != 0xff; sync++) {
+      for (i = 0, pdo = sync->pdos; i < sync->n_pdos; i++, pdo++) {
+        for (j = 0; j < pdo->n_entries; j++) {
+          if (pdo->entries[j].index == reg->index && pdo->entries[j].subindex == reg->subindex) {
+            return sync->dir;
+          }
+        }
+      }
+    }
+  }
+
+  // default mapping of the slave
+  if (ecrt_master_get_slave(master, slave->index, &slave_info) != 0) {
+    return EC_DIR_INVALID;
+  }
+  for (sm = 0; sm < slave_info.sync_count; sm++) {
+    if (ecrt_master_get_sync_manager(master, slave->index, sm, &sync_info) != 0) {
+      continue;
+    }
+    for (i = 0; i < sync_info.n_pdos; i++) {
+      if (ecrt_master_get_pdo(master, slave->index, sm, i, &pdo_info) != 0) {
+        continue;
+      }
+      for (j = 0; j < pdo_info.n_entries; j++) {
+        if (ecrt_master_get_pdo_entry(master, slave->index, sm, i, j, &entry_info) != 0) {
+          continue;
+        }
+        if (entry_info.index == reg->index && entry_info.subindex == reg->subindex) {
+          return sync_info.dir;
+        }
+      }
+    }
+  }
+
+  return EC_DIR_INVALID;
+}
+
+/// @brief Split the master's PDO entry registrations by domain and register them.
+/// @return 0 for success, nonzero for failure.
+static int lcec_register_domains(lcec_master_t *master) {
+  lcec_slave_t *slave;
+  lcec_domain_t *domain;
+  ec_pdo_entry_reg_t *reg;
+  int i;
+#ifdef __KERNEL__
+  int used_domains;
+  size_t size;
+  uint8_t *mem;
+#endif
+
+  // count entries per domain
+  reg = master->pdo_entry_regs;
+  for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+    for (i = 0; i < slave->pdo_entry_count; i++, reg++) {
+      lcec_pdo_reg_domain(slave, reg)->pdo_entry_count++;
+    }
+  }
+
+  // alloc entry lists, terminated by an empty entry
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    domain->pdo_entry_regs = lcec_zalloc(sizeof(ec_pdo_entry_reg_t) * (domain->pdo_entry_count + 1));
+    if (domain->pdo_entry_regs == NULL) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate domain %s.%s PDO entry memory\n", master->name, domain->name);
+      return -1;
+    }
+    domain->pdo_entry_count = 0;
+  }
+
+  // distribute entries
+  reg = master->pdo_entry_regs;
+  for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+    for (i = 0; i < slave->pdo_entry_count; i++, reg++) {
+      domain = lcec_pdo_reg_domain(slave, reg);
+      domain->pdo_entry_regs[domain->pdo_entry_count++] = *reg;
+    }
+  }
+
+  // register entries
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain->pdo_entry_count == 0) {
+      continue;
+    }
+    if (ecrt_domain_reg_pdo_entry_list(domain->domain, domain->pdo_entry_regs)) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s domain %s PDO entry registration failed\n", master->name, domain->name);
+      return -1;
+    }
+  }
+
+#ifdef __KERNEL__
+  // kernel domains allocate their own memory, so provide one block
+  // for all of them to keep the process data image contiguous
+  used_domains = 0;
+  size = 0;
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain->pdo_entry_count > 0) {
+      used_domains++;
+      size += ecrt_domain_size(domain->domain);
+    }
+  }
+  if (used_domains > 1) {
+    if ((master->process_data_mem = lcec_zalloc(size)) == NULL) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s process data memory\n", master->name);
+      return -1;
+    }
+    mem = master->process_data_mem;
+    for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+      if (domain->pdo_entry_count > 0) {
+        ecrt_domain_external_memory(domain->domain, mem);
+        mem += ecrt_domain_size(domain->domain);
+      }
+    }
+  }
+#endif
+
+  return 0;
+}
+
+/// @brief Set up the master's process data image after activation.
+///
+/// Drivers address all process data relative to `master->process_data`.
+/// The domains are laid out contiguously, so the lowest domain address
+/// becomes the image base and every registered offset is moved by its
+/// domain's distance from that base.
+/// @return 0 for success, nonzero for failure.
+static int lcec_map_domains(lcec_master_t *master) {
+  lcec_domain_t *domain;
+  ec_pdo_entry_reg_t *reg;
+  uint8_t *data;
+  unsigned int delta;
+  int i, len;
+
+  // find image base
+  master->process_data = NULL;
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain->pdo_entry_count == 0) {
+      // nothing to exchange, never queued
+      domain->data_valid = 1;
+      continue;
+    }
+    if ((data = ecrt_domain_data(domain->domain)) == NULL) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "master %s domain %s has no process data\n", master->name, domain->name);
+      return -1;
+    }
+    if (master->process_data == NULL || data < master->process_data) {
+      master->process_data = data;
+    }
+  }
+
+  // rebase offsets
+  master->process_data_len = 0;
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain->pdo_entry_count == 0) {
+      continue;
+    }
+    delta = ecrt_domain_data(domain->domain) - master->process_data;
+    if (delta > 0) {
+      for (i = 0, reg = domain->pdo_entry_regs; i < domain->pdo_entry_count; i++, reg++) {
+        if (reg->offset != NULL) {
+          *(reg->offset) += delta;
+        }
+      }
+    }
+    domain->data_size = ecrt_domain_size(domain->domain);
+    domain->datagram_count = (domain->data_size + LCEC_MAX_DATAGRAM_DATA - 1) / LCEC_MAX_DATAGRAM_DATA;
+    len = delta + domain->data_size;
+    if (len > master->process_data_len) {
+      master->process_data_len = len;
+    }
+  }
+
+  return 0;
+}
+
+/// @brief Build the flattened per-slave tables used by the RT functions.
+///
+/// The RT cycle only needs a few fields of each slave.  Walking the
+/// slave list pulls every `lcec_slave_t` (names, configs, ...) into
+/// the cache, so the callbacks and state poll data are copied into
+/// contiguous, cache line aligned arrays instead.  Slaves without a
+/// read or write callback are left out of the respective table.
+/// Callbacks of low priority slaves go into separate tables for the
+/// `read-slow` and `write-slow` functions.
+/// @return 0 for success, nonzero for failure.
+static int lcec_build_rt_tables(lcec_master_t *master) {
+  lcec_slave_t *slave;
+  size_t polls_size, reads_size, writes_size, slow_reads_size, slow_writes_size;
+  uintptr_t base;
+  int i;
+
+  // count entries
+  master->slave_count = 0;
+  for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+    master->slave_count++;
+  }
+  master->read_call_count = lcec_fill_call_table(master, NULL, 0, 0, NULL);
+  master->write_call_count = lcec_fill_call_table(master, NULL, 1, 0, NULL);
+  master->slow_read_call_count = lcec_fill_call_table(master, NULL, 0, 1, NULL);
+  master->slow_write_call_count = lcec_fill_call_table(master, NULL, 1, 1, NULL);
+
+  // alloc one block, every table starts on its own cache line
+  polls_size = LCEC_CACHELINE_ALIGN(sizeof(lcec_slave_poll_t) * master->slave_count);
+  reads_size = LCEC_CACHELINE_ALIGN(sizeof(lcec_slave_call_t) * master->read_call_count);
+  writes_size = LCEC_CACHELINE_ALIGN(sizeof(lcec_slave_call_t) * master->write_call_count);
+  slow_reads_size = LCEC_CACHELINE_ALIGN(sizeof(lcec_slave_call_t) * master->slow_read_call_count);
+  slow_writes_size = LCEC_CACHELINE_ALIGN(sizeof(lcec_slave_call_t) * master->slow_write_call_count);
+  master->rt_tables = lcec_zalloc(polls_size + reads_size + writes_size + slow_reads_size + slow_writes_size + LCEC_CACHELINE_SIZE);
+  if (master->rt_tables == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s RT table memory\n", master->name);
+    return -1;
+  }
+  base = LCEC_CACHELINE_ALIGN((uintptr_t)master->rt_tables);
+  master->state_polls = (lcec_slave_poll_t *)base;
+  base += polls_size;
+  master->read_calls = (lcec_slave_call_t *)base;
+  base += reads_size;
+  master->write_calls = (lcec_slave_call_t *)base;
+  base += writes_size;
+  master->slow_read_calls = (lcec_slave_call_t *)base;
+  base += slow_reads_size;
+  master->slow_write_calls = (lcec_slave_call_t *)base;
+
+  // fill tables
+  for (slave = master->first_slave, i = 0; slave != NULL; slave = slave->next, i++) {
+    master->state_polls[i].config = slave->config;
+    master->state_polls[i].state = &slave->state;
+    master->state_polls[i].hal_state_data = slave->hal_state_data;
+  }
+  lcec_fill_call_table(master, master->read_calls, 0, 0, &master->read_noncrit_first);
+  lcec_fill_call_table(master, master->write_calls, 1, 0, &master->write_noncrit_first);
+  lcec_fill_call_table(master, master->slow_read_calls, 0, 1, NULL);
+  lcec_fill_call_table(master, master->slow_write_calls, 1, 1, NULL);
+
+  return 0;
+}
+
+/// @brief Allocate the process data copy of a master's low priority slaves.
+///
+/// The slow functions must not touch `process_data` while the fast
+/// functions exchange it, so `read-slow` and `write-slow` work on a
+/// copy and only exchange it under the master's lock.
+/// @return 0 for success, nonzero for failure.
+static int lcec_init_slow_data(lcec_master_t *master) {
+  size_t len = master->process_data_len;
+
+  if (master->slow_read_call_count == 0 && master->slow_write_call_count == 0) {
+    return 0;
+  }
+
+  if (master->exclusive) {
+    rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "exclusive mode for master %s ignored, the slow functions share the master\n",
+        master->name);
+    master->exclusive = 0;
+  }
+
+  // data, snapshot, pending outputs and their mask in one block
+  master->slow_data = lcec_zalloc(4 * len);
+  if (master->slow_data == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s slow process data memory\n", master->name);
+    return -1;
+  }
+  master->slow_snapshot = master->slow_data + len;
+  master->slow_out = master->slow_snapshot + len;
+  master->slow_out_mask = master->slow_out + len;
+  memcpy(master->slow_data, master->process_data, len);
+  memcpy(master->slow_snapshot, master->process_data, len);
+
+  return 0;
+}
+
+/// @brief Check if a slave's callbacks access other slaves' process data.
+///
+/// FSoE slaves copy their safety data into the logic device's process
+/// data, so they and the logic devices must not run in parallel.
+static inline int lcec_slave_needs_serial(lcec_slave_t *slave) { return slave->is_fsoe_logic || slave->fsoeConf != NULL; }
+
+/// @brief Check if a slave's callbacks must run even if the cycle budget is exceeded.
+///
+/// Safety slaves are always critical, so they keep their order.
+static inline int lcec_slave_is_critical(lcec_slave_t *slave) { return !slave->non_critical || lcec_slave_needs_serial(slave); }
+
+/// @brief Configure a slave: write its SDO and IDN configuration and call its driver's `proc_init`.
+///
+/// The PDO entries are registered in a scratch table first, so that the
+/// check for surplus entries also works while the following slave is
+/// being initialized at the same time.
+/// @return 0 on success, or -1 if the slave can't be used.
+static int lcec_init_slave(lcec_slave_t *slave) {
+  lcec_master_t *master = slave->master;
+  lcec_slave_sdoconf_t *sdo_config;
+  lcec_slave_idnconf_t *idn_config;
+  ec_pdo_entry_reg_t *pdo_entry_regs;
+  long long t_start;
+  int ret = -1;
+
+  // initialize sdos
+  t_start = rtapi_get_time();
+  if (slave->sdo_config != NULL) {
+    for (sdo_config = slave->sdo_config; sdo_config->index != 0xffff;
+         sdo_config = (lcec_slave_sdoconf_t *)&sdo_config->data[sdo_config->length]) {
+      if (sdo_config->subindex == LCEC_CONF_SDO_COMPLETE_SUBIDX) {
+        if (ecrt_slave_config_complete_sdo(slave->config, sdo_config->index, &sdo_config->data[0], sdo_config->length) != 0) {
+          rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failed to configure slave %s.%s sdo %04x (complete)\n", master->name, slave->name,
+              sdo_config->index);
+        }
+      } else {
+        if (lcec_write_sdo(slave, sdo_config->index, sdo_config->subindex, &sdo_config->data[0], sdo_config->length) != 0) {
+          rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failed to configure slave %s.%s sdo %04x:%02x\n", master->name, slave->name,
+              sdo_config->index, sdo_config->subindex);
+        }
+      }
+    }
+  }
+
+  // initialize idns
+  if (slave->idn_config != NULL) {
+    for (idn_config = slave->idn_config; idn_config->state != 0;
+         idn_config = (lcec_slave_idnconf_t *)&idn_config->data[idn_config->length]) {
+      if (ecrt_slave_config_idn(
+              slave->config, idn_config->drive, idn_config->idn, idn_config->state, &idn_config->data[0], idn_config->length) != 0) {
+        rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "fail to configure slave %s.%s drive %d idn %c-%d-%d (state %d, length %u)\n",
+            master->name, slave->name, idn_config->drive, (idn_config->idn & 0x8000) ? 'P' : 'S', (idn_config->idn >> 12) & 0x0007,
+            idn_config->idn & 0x0fff, idn_config->state, (unsigned int)idn_config->length);
+      }
+    }
+  }
+  slave->startup.config_time = rtapi_get_time() - t_start;
+
+  // setup pdos
+  pdo_entry_regs = lcec_zalloc(sizeof(ec_pdo_entry_reg_t) * (slave->pdo_entry_count + 2));
+  if (pdo_entry_regs == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave %s.%s PDO entry memory\n", master->name, slave->name);
+    return -1;
+  }
+  if (slave->proc_init != NULL) {
+    rtapi_print_msg(RTAPI_MSG_DBG, LCEC_MSG_PFX "proc_init for slave %s.%s\n", master->name, slave->name);
+    t_start = rtapi_get_time();
+    if ((slave->proc_init(lcec_comp_id, slave, pdo_entry_regs)) != 0) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "failure in proc_init for slave %s.%s\n", master->name, slave->name);
+      goto out;
+    }
+    slave->startup.init_time = rtapi_get_time() - t_start;
+  }
+  if (lcec_check_pdo_regs(slave, pdo_entry_regs, slave->pdo_entry_count) != 0) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "PDO reg check failure for slave %s.%s\n", master->name, slave->name);
+    goto out;
+  }
+  memcpy(slave->pdo_entry_regs, pdo_entry_regs, sizeof(ec_pdo_entry_reg_t) * slave->pdo_entry_count);
+  ret = 0;
+
+out:
+  lcec_free(pdo_entry_regs);
+  return ret;
+}
+
+/// @brief Job function for `lcec_init_slaves()`.
+static int lcec_init_slave_job(void *arg, int index) { return lcec_init_slave(((lcec_slave_t **)arg)[index]); }
+
+/// @brief Initialize the slaves of all masters.
+///
+/// Each master initializes up to `init_threads` slaves at the same
+/// time, and all masters run at the same time, so that blocking SDO
+/// transfers overlap.  Safety slaves are initialized afterwards, in
+/// order.  With `init_threads` at 1, all slaves of a master are
+/// initialized in order, one master after the other.
+///
+/// With `init_threads` above 1, `proc_init` of several slaves runs at
+/// the same time, so it must only touch its own slave.  Helpers that
+/// register with the master, like `lcec_interp_init()` and
+/// `lcec_fb_avg_init()`, take the master's mutex.
+/// @return 0 on success, or -1 if any slave failed.
+static int lcec_init_slaves(void) {
+  lcec_master_t *master;
+  lcec_slave_t *slave;
+  lcec_slave_t ***slaves;
+  lcec_jobs_t **jobs;
+  char name[LCEC_CONF_STR_MAXLEN];
+  int master_count, count, failed, i;
+
+  master_count = 0;
+  for (master = first_master; master != NULL; master = master->next) {
+    master_count++;
+  }
+
+  slaves = lcec_zalloc(sizeof(lcec_slave_t **) * master_count);
+  jobs = lcec_zalloc(sizeof(lcec_jobs_t *) * master_count);
+  if (slaves == NULL || jobs == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate slave init memory\n");
+    failed = 1;
+    goto out;
+  }
+
+  // start the slaves of all masters
+  failed = 0;
+  for (master = first_master, i = 0; master != NULL; master = master->next, i++) {
+    count = 0;
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+      count++;
+    }
+    slaves[i] = lcec_zalloc(sizeof(lcec_slave_t *) * (count + 1));
+    if (slaves[i] == NULL) {
+      rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s slave init memory\n", master->name);
+      failed++;
+      break;
+    }
+
+    count = 0;
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+      if (master->init_threads <= 1 || !lcec_slave_needs_serial(slave)) {
+        slaves[i][count++] = slave;
+      }
+    }
+
+    rtapi_snprintf(name, LCEC_CONF_STR_MAXLEN, "%s.init", master->name);
+    jobs[i] = lcec_jobs_start(name, master->init_threads, lcec_init_slave_job, slaves[i], count);
+    if (jobs[i] == NULL) {
+      failed++;
+      break;
+    }
+  }
+
+  // wait for them, then initialize the remaining slaves
+  for (master = first_master, i = 0; master != NULL && jobs[i] != NULL; master = master->next, i++) {
+    failed += lcec_jobs_wait(jobs[i]);
+    if (master->init_threads > 1) {
+      for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+        if (lcec_slave_needs_serial(slave) && lcec_init_slave(slave) != 0) {
+          failed++;
+        }
+      }
+    }
+  }
+
+out:
+  if (slaves != NULL) {
+    for (i = 0; i < master_count; i++) {
+      if (slaves[i] != NULL) {
+        lcec_free(slaves[i]);
+      }
+    }
+    lcec_free(slaves);
+  }
+  if (jobs != NULL) {
+    lcec_free(jobs);
+  }
+  return (failed > 0) ? -1 : 0;
+}
+
+/// @brief Fill a callback table with the read or write callbacks of a master's slaves.
+///
+/// Critical slaves come first, in slave order, followed by the
+/// non-critical ones.
+/// @param calls The table to fill, or NULL to only count the entries.
+/// @param write Use `proc_write` instead of `proc_read`.
+/// @param low_priority Select low priority slaves instead of normal ones.
+/// @param noncrit_first Where to store the index of the first non-critical slave, or NULL.
+/// @return The number of entries.
+static int lcec_fill_call_table(lcec_master_t *master, lcec_slave_call_t *calls, int write, int low_priority, int *noncrit_first) {
+  lcec_slave_t *slave;
+  lcec_slave_rw_t proc;
+  int count = 0;
+  int critical;
+
+  for (critical = 1; critical >= 0; critical--) {
+    if (!critical && noncrit_first != NULL) {
+      *noncrit_first = count;
+    }
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+      proc = write ? slave->proc_write : slave->proc_read;
+      if (proc == NULL || slave->low_priority != low_priority || lcec_slave_is_critical(slave) != critical) {
+        continue;
+      }
+      if (calls != NULL) {
+        calls[count].proc = proc;
+        calls[count].slave = slave;
+        calls[count].profile = slave->profile;
+        calls[count].data_valid = NULL;
+        if (!write && master->wc_policy == lcecWcPolicyHold) {
+          calls[count].data_valid = &lcec_slave_input_domain(slave)->data_valid;
+        }
+      }
+      count++;
+    }
+  }
+
+  return count;
+}
+
+/// @brief Start the driver worker threads of a master and split its callback tables between them.
+/// @return 0 for success, nonzero for failure.
+static int lcec_init_driver_workers(lcec_master_t *master) {
+  char name[LCEC_CONF_STR_MAXLEN];
+  int cpu, i;
+
+  // count workers, one per cpu
+  for (cpu = 0; cpu < 64; cpu++) {
+    if (master->driver_cpus & (1ULL << cpu)) {
+      master->driver_worker_count++;
+    }
+  }
+
+  // alloc memory
+  master->driver_workers = lcec_zalloc(sizeof(lcec_worker_t *) * master->driver_worker_count);
+  master->read_chunks = lcec_zalloc(sizeof(lcec_call_chunk_t) * (master->driver_worker_count + 1));
+  master->write_chunks = lcec_zalloc(sizeof(lcec_call_chunk_t) * (master->driver_worker_count + 1));
+  if (master->driver_workers == NULL || master->read_chunks == NULL || master->write_chunks == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s driver worker memory\n", master->name);
+    return -1;
+  }
+
+  // split tables
+  master->read_serial_first =
+      lcec_split_call_table(master->read_calls, master->read_call_count, master->read_chunks, master->driver_worker_count + 1, 0);
+  master->write_serial_first =
+      lcec_split_call_table(master->write_calls, master->write_call_count, master->write_chunks, master->driver_worker_count + 1, 1);
+  if (master->read_serial_first < 0 || master->write_serial_first < 0) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate master %s driver worker memory\n", master->name);
+    return -1;
+  }
+
+  // start workers
+  for (cpu = 0, i = 0; cpu < 64; cpu++) {
+    if (master->driver_cpus & (1ULL << cpu)) {
+      rtapi_snprintf(name, LCEC_CONF_STR_MAXLEN, "%s.driver-%d", master->name, i);
+      if ((master->driver_workers[i] = lcec_worker_start(name, 1ULL << cpu)) == NULL) {
+        return -1;
+      }
+      i++;
+    }
+  }
+
+  return 0;
+}
+
+/// @brief Split a callback table into chunks that can run in parallel.
+///
+/// Calls of slaves that must run serially are moved to the end of the
+/// table, keeping their order.  The remaining calls are split into
+/// `chunk_count` contiguous chunks of about the same size.
+/// @return The index of the first serial call, or -1 on error.
+static int lcec_split_call_table(lcec_slave_call_t *calls, int count, lcec_call_chunk_t *chunks, int chunk_count, int write) {
+  lcec_slave_call_t *tmp;
+  int i, parallel_count, serial_count;
+
+  // move serial calls to the end
+  tmp = lcec_zalloc(sizeof(lcec_slave_call_t) * (count + 1));
+  if (tmp == NULL) {
+    return -1;
+  }
+  for (i = 0, parallel_count = 0, serial_count = 0; i < count; i++) {
+    if (!lcec_slave_needs_serial(calls[i].slave)) {
+      calls[parallel_count++] = calls[i];
+    } else {
+      tmp[serial_count++] = calls[i];
+    }
+  }
+  memcpy(&calls[parallel_count], tmp, sizeof(lcec_slave_call_t) * serial_count);
+  lcec_free(tmp);
+
+  // split parallel calls
+  for (i = 0; i < chunk_count; i++) {
+    chunks[i].first = &calls[parallel_count * i / chunk_count];
+    chunks[i].end = &calls[parallel_count * (i + 1) / chunk_count];
+    chunks[i].write = write;
+  }
+
+  return parallel_count;
+}
+
+/// @brief Estimate how long it takes from sending a frame until its outputs have reached the last slave.
+///
+/// This is the time to put the whole frame on the wire at 100 MBit/s,
+/// plus the propagation delays that the master measured for distributed
+/// clocks while scanning the bus.  For trees, all branches are added up,
+/// so the estimate errs on the late side.
+/// @return The estimated frame time, in ns.
+static uint32_t lcec_estimate_frame_time(lcec_master_t *master) {
+  lcec_domain_t *domain;
+  ec_master_info_t master_info;
+  ec_slave_info_t slave_info;
+  uint64_t bytes;
+  uint32_t delay;
+  unsigned int i, port;
+
+  // process data datagrams plus the DC sync datagram
+  bytes = LCEC_FRAME_OVERHEAD + LCEC_DATAGRAM_OVERHEAD + 8;
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain->pdo_entry_count > 0) {
+      bytes += LCEC_DATAGRAM_OVERHEAD + ecrt_domain_size(domain->domain);
+    }
+  }
+
+  // measured propagation delays
+  delay = 0;
+  if (ecrt_master(master->master, &master_info) == 0) {
+    for (i = 0; i < master_info.slave_count; i++) {
+      if (ecrt_master_get_slave(master->master, i, &slave_info) != 0) {
+        continue;
+      }
+      for (port = 0; port < EC_MAX_PORTS; port++) {
+        delay += slave_info.ports[port].delay_to_next_dc;
+      }
+    }
+  }
+
+  return bytes * LCEC_NS_PER_BYTE + delay;
+}
+
+/// @brief Compute and configure `sync0Shift` for all slaves with `sync0Shift="auto"`.
+///
+/// The shift puts SYNC0 `sync0ShiftMargin` after the outputs of a frame
+/// sent at `send_offset` have reached the last slave.  It is applied
+/// with `ecrt_slave_config_dc()`, which only takes effect when the
+/// master (re)configures the slave.
+/// @param send_offset Time from the start of the DC cycle to `ecrt_master_send()`, in ns.
+/// @param msg_level Message level for reporting the shifts.
+static void lcec_apply_sync0_shift(lcec_master_t *master, uint32_t send_offset, int msg_level) {
+  lcec_slave_t *slave;
+  lcec_slave_dc_t *dc;
+
+  for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+    dc = slave->dc_conf;
+    if (dc == NULL || !dc->sync0ShiftAuto) {
+      continue;
+    }
+
+    dc->sync0Shift = ((uint64_t)send_offset + master->frame_time + dc->sync0ShiftMargin) % master->app_time_period;
+    ecrt_slave_config_dc(slave->config, dc->assignActivate, dc->sync0Cycle, dc->sync0Shift, dc->sync1Cycle, dc->sync1Shift);
+    rtapi_print_msg(
+        msg_level, LCEC_MSG_PFX "slave %s.%s: sync0Shift=auto, using sync0Shift=%d\n", master->name, slave->name, dc->sync0Shift);
+  }
+}
+
+/// @brief Update HAL pins for the master.
+void lcec_update_master_hal(lcec_master_data_t *hal_data, ec_master_state_t *ms) {
+  *(hal_data->slaves_responding) = ms->slaves_responding;
+  *(hal_data->state_init) = (ms->al_states & 0x01) != 0;
+  *(hal_data->state_preop) = (ms->al_states & 0x02) != 0;
+  *(hal_data->state_safeop) = (ms->al_states & 0x04) != 0;
+  *(hal_data->state_op) = (ms->al_states & 0x08) != 0;
+  *(hal_data->link_up) = ms->link_up;
+  *(hal_data->all_op) = (ms->al_states == 0x08);
+}
+
+/// @brief Update generic HAL pins for a slave.
+void lcec_update_slave_state_hal(lcec_slave_state_t *hal_data, ec_slave_config_state_t *ss) {
+  *(hal_data->online) = ss->online;
+  *(hal_data->operational) = ss->operational;
+  *(hal_data->state_init) = (ss->al_state & 0x01) != 0;
+  *(hal_data->state_preop) = (ss->al_state & 0x02) != 0;
+  *(hal_data->state_safeop) = (ss->al_state & 0x04) != 0;
+  *(hal_data->state_op) = (ss->al_state & 0x08) != 0;
+}
+
+/// @brief Check the working counter of a domain and update its HAL pins.
+void lcec_update_domain_hal(lcec_domain_t *domain) {
+  lcec_domain_data_t *hal_data = domain->hal_data;
+
+  domain->data_valid = (domain->state.wc_state == EC_WC_COMPLETE);
+  if (domain->data_valid) {
+    domain->complete_seen = 1;
+    *(hal_data->expected_wc) = domain->state.working_counter;
+  } else if (domain->complete_seen) {
+    (*(hal_data->missed_frames))++;
+  }
+
+  *(hal_data->working_counter) = domain->state.working_counter;
+  *(hal_data->wc_state) = domain->state.wc_state;
+  *(hal_data->data_valid) = domain->data_valid;
+}
+
+/// @brief Update all input pins across all masters and slaves.
+void lcec_read_all(void *arg, long period) {
+  lcec_master_t *master;
+
+  // initialize global state
   global_ms.slaves_responding = 0;
   global_ms.al_states = 0;
   global_ms.link_up = (first_master != NULL);
 
-  // process slaves
+  // process slaves, masters with a worker thread run in parallel
   for (master = first_master; master != NULL; master = master->next) {
-    lcec_read_master(master, period);
+    if (master->worker != NULL) {
+      lcec_worker_run(master->worker, lcec_read_master, master, period);
+    }
+  }
+  for (master = first_master; master != NULL; master = master->next) {
+    if (master->worker == NULL) {
+      lcec_read_master(master, period);
+    }
+  }
+  for (master = first_master; master != NULL; master = master->next) {
+    if (master->worker != NULL) {
+      lcec_worker_wait(master->worker);
+    }
+  }
+
+  // update global state
+  for (master = first_master; master != NULL; master = master->next) {
+    global_ms.slaves_responding += master->ms.slaves_responding;
+    global_ms.al_states |= master->ms.al_states;
+    global_ms.link_up = global_ms.link_up && master->ms.link_up;
   }
 
   // update global state pins
   lcec_update_master_hal(global_hal_data, &global_ms);
 }
 
+/// @brief Check if `lcec_write_all()` may run a master's write in its worker thread.
+static inline int lcec_write_in_worker(lcec_master_t *master) {
+#ifdef RTAPI_TASK_PLL_SUPPORT
+  // the thread PLL can only be adjusted from the HAL thread
+  if (master->sync_ref_cycles < 0) {
+    return 0;
+  }
+#endif
+  return master->worker != NULL;
+}
+
 /// @brief Update all output pins across all masters and slaves.
 void lcec_write_all(void *arg, long period) {
   lcec_master_t *master;
 
-  // process slaves
+  // process slaves, masters with a worker thread run in parallel
   for (master = first_master; master != NULL; master = master->next) {
-    lcec_write_master(master, period);
+    if (lcec_write_in_worker(master)) {
+      lcec_worker_run(master->worker, lcec_write_master, master, period);
+    }
+  }
+  for (master = first_master; master != NULL; master = master->next) {
+    if (!lcec_write_in_worker(master)) {
+      lcec_write_master(master, period);
+    }
+  }
+  for (master = first_master; master != NULL; master = master->next) {
+    if (lcec_write_in_worker(master)) {
+      lcec_worker_wait(master->worker);
+    }
   }
 }
 
+/// @brief Read and write all pins across all masters and slaves in one function.
+///
+/// Like `lcec_cycle_master()`, for `read-all` and `write-all`.
+void lcec_cycle_all(void *arg, long period) {
+  lcec_read_all(arg, period);
+  lcec_write_all(arg, period);
+}
+
 /// @brief Read all input pins on a master and its slaves.
 void lcec_read_master(void *arg, long period) {
   lcec_master_t *master = (lcec_master_t *)arg;
+  lcec_master_data_t *hal_data = master->hal_data;
   lcec_slave_t *slave;
+  lcec_domain_t *domain;
+  lcec_slave_poll_t *poll;
   int check_states;
+  long long t_start, t_frame, t_receive, t_read;
+  int i, poll_first, poll_end;
 
   // check period
   if (period != master->period_last) {
@@ -1154,93 +2411,383 @@ void lcec_read_master(void *arg, long period) {
     }
   }
 
+  // reset timing statistics
+  if (*(hal_data->stats_reset)) {
+    for (i = 0; i < LCEC_TIMING_PHASE_COUNT; i++) {
+      lcec_timing_reset(&hal_data->timing[i]);
+    }
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+      if (slave->profile != NULL) {
+        lcec_profile_reset(slave->profile);
+      }
+    }
+    lcec_dc_stats_reset(&hal_data->dc_stats);
+  }
+
   // get state check flag
   if (master->state_update_timer > 0) {
     check_states = 0;
     master->state_update_timer -= period;
   } else {
     check_states = 1;
-    master->state_update_timer = LCEC_STATE_UPDATE_PERIOD;
+    master->state_update_timer = master->state_update_period;
   }
 
-  // receive process data & master state
-  rtapi_mutex_get(&master->mutex);
-  ecrt_master_receive(master->master);
-  ecrt_domain_process(master->domain);
+  // start a new slave state sweep, unless the last one is still running
+  if (check_states && master->state_update_next < 0) {
+    master->state_update_next = 0;
+  }
+
+  // get range of slaves to poll, limited to state_update_slaves per cycle if set
+  poll_first = master->state_update_next;
+  if (poll_first < 0) {
+    poll_first = poll_end = 0;
+  } else if (master->state_update_slaves > 0 && poll_first + master->state_update_slaves < master->slave_count) {
+    poll_end = poll_first + master->state_update_slaves;
+    master->state_update_next = poll_end;
+  } else {
+    poll_end = master->slave_count;
+    master->state_update_next = -1;
+  }
+
+  // receive process data, master state & slave states
+  LCEC_TRACE1(read_begin, master->name);
+  t_start = rtapi_get_time();
+  t_frame = 0;
+  lcec_master_lock(master);
+  if (master->bus != NULL) {
+    // the bus thread has received the process data already
+    lcec_bus_read(master);
+  } else {
+    t_frame = rtapi_get_time();
+    ecrt_master_receive(master->master);
+    for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+      if (domain->queued) {
+        ecrt_domain_process(domain->domain);
+        ecrt_domain_state(domain->domain, &domain->state);
+        domain->queued = 0;
+        domain->hal_pending = 1;
+      }
+    }
+  }
   if (check_states) {
     ecrt_master_state(master->master, &master->ms);
   }
-  rtapi_mutex_give(&master->mutex);
+  for (poll = &master->state_polls[poll_first]; poll < &master->state_polls[poll_end]; poll++) {
+    ecrt_slave_config_state(poll->config, poll->state);
+  }
+  lcec_master_unlock(master);
+  t_receive = rtapi_get_time();
+  LCEC_TRACE1(read_received, master->name);
+
+  // timestamp the receive on the application time scale
+  if (t_frame != 0 && master->timestamp.app_time != 0) {
+    master->timestamp.receive_time = master->timestamp.app_time + (t_frame - master->app_time_clock);
+    lcec_set_u64_pins(hal_data->dc_receive_time_lo, hal_data->dc_receive_time_hi, master->timestamp.receive_time);
+  }
 
-  // update state pins
-  lcec_update_master_hal(master->hal_data, &master->ms);
+  // check working counters, domains that were not exchanged keep their last state
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain->hal_pending) {
+      lcec_update_domain_hal(domain);
+      domain->hal_pending = 0;
+    }
+  }
 
-  // update global state
-  global_ms.slaves_responding += master->ms.slaves_responding;
-  global_ms.al_states |= master->ms.al_states;
-  global_ms.link_up = global_ms.link_up && master->ms.link_up;
+  // update state pins
+  lcec_update_master_hal(hal_data, &master->ms);
+  if (master->op_time == 0 && *(hal_data->all_op)) {
+    master->op_time = rtapi_get_time() - startup.start;
+    rtapi_print_msg(RTAPI_MSG_INFO, LCEC_MSG_PFX "master %s: all slaves in OP %d ms after startup\n", master->name,
+        (int)lcec_div_64(master->op_time, 1000000));
+  }
+  for (poll = &master->state_polls[poll_first]; poll < &master->state_polls[poll_end]; poll++) {
+    lcec_update_slave_state_hal(poll->hal_state_data, poll->state);
+  }
 
-  // process slaves
-  for (slave = master->first_slave; slave != NULL; slave = slave->next) {
-    // get slaves state
-    rtapi_mutex_get(&master->mutex);
-    if (check_states) {
-      ecrt_slave_config_state(slave->config, &slave->state);
+  // process slaves, lcec_run_calls() skips those whose inputs are incomplete and should be held
+  master->budget_exceeded = 0;
+  if (master->driver_worker_count > 0) {
+    lcec_run_calls_parallel(
+        master, master->read_chunks, master->read_calls, master->read_serial_first, master->read_call_count, period, 0);
+  } else {
+    // critical slaves first, the others only if there is time left
+    lcec_run_calls(master->read_calls, master->read_calls + master->read_noncrit_first, period, 0);
+    master->budget_exceeded = lcec_cycle_budget_exceeded(master, rtapi_get_time() - t_start);
+    if (!master->budget_exceeded) {
+      lcec_run_calls(master->read_calls + master->read_noncrit_first, master->read_calls + master->read_call_count, period, 0);
     }
-    rtapi_mutex_give(&master->mutex);
-    if (check_states) {
-      lcec_update_slave_state_hal(slave->hal_state_data, &slave->state);
+  }
+  t_read = rtapi_get_time();
+  master->cycle_used = t_read - t_start;
+  LCEC_TRACE1(read_end, master->name);
+
+  // publish profiling data
+  if (master->profile_slaves) {
+    if (master->profile_update_timer > 0) {
+      master->profile_update_timer -= period;
+    } else {
+      master->profile_update_timer = LCEC_STATE_UPDATE_PERIOD;
+      lcec_profile_publish(master);
     }
+  }
+
+  // update timing statistics
+  lcec_timing_update(&hal_data->timing[LCEC_TIMING_RECEIVE], t_receive - t_start, hal_data->timing_hist_width);
+  lcec_timing_update(&hal_data->timing[LCEC_TIMING_READ], t_read - t_receive, hal_data->timing_hist_width);
+  if (t_frame != 0 && master->send_time != 0) {
+    lcec_timing_update(&hal_data->timing[LCEC_TIMING_LATENCY], t_frame - master->send_time, hal_data->timing_hist_width);
+  }
+}
+
+#ifdef RTAPI_TASK_PLL_SUPPORT
+/// @brief Limit a period correction to +/- `pll-step` and round it to ns.
+static int32_t lcec_pll_limit(lcec_master_t *master, double out) {
+  double limit = master->hal_data->pll_step;
+
+  if (out > limit) {
+    out = limit;
+  } else if (out < -limit) {
+    out = -limit;
+  }
+
+  return (int32_t)((out < 0) ? out - 0.5 : out + 0.5);
+}
 
-    // process read function
-    if (slave->proc_read != NULL) {
-      slave->proc_read(slave, period);
+/// @brief PI controller for syncing the master thread to the reference clock.
+///
+/// The output is limited to +/- `pll-step`.  The integral part is only
+/// updated while the output is not limited, so it does not wind up
+/// during large errors.  It is kept across resyncs, since it holds the
+/// frequency offset between the thread and the reference clock.
+/// @param err The error between the application time and the reference clock, in ns.
+/// @return The period correction, in ns.
+static int32_t lcec_pll_pi(lcec_master_t *master, int32_t err) {
+  lcec_master_data_t *hal_data = master->hal_data;
+  double limit = hal_data->pll_step;
+  double integral, out;
+
+  integral = master->pll_integral + hal_data->pll_i_gain * err;
+  out = hal_data->pll_p_gain * err + integral;
+  if (out <= limit && out >= -limit) {
+    master->pll_integral = integral;
+  }
+
+  return lcec_pll_limit(master, out);
+}
+#endif
+
+/// @brief Measure the send time for `sync0Shift="auto"`.
+///
+/// The send time is taken modulo the cycle, relative to the DC cycle
+/// start.  Min and max are tracked relative to the first sample, so
+/// sends close to the cycle start don't wrap around.  After
+/// `sync0ShiftCycles` samples, the latest send time is used to compute
+/// the shifts.  This runs in the cycle, so it only publishes the
+/// measurement and leaves the blocking reconfiguration and the reporting
+/// to `lcec_sync0_shift_task()`.
+/// @param send_time The application time of the send.
+static void lcec_sync0_shift_sample(lcec_master_t *master, uint64_t send_time) {
+  lcec_master_data_t *hal_data = master->hal_data;
+  int32_t period = master->app_time_period;
+  int32_t delta;
+  uint32_t offset;
+
+  delta = (send_time - master->app_time_start) % period;
+  if (master->sync0_shift_samples == 0) {
+    master->sync0_send_phase = delta;
+    delta = 0;
+  } else {
+    delta -= master->sync0_send_phase;
+    if (delta > period / 2) {
+      delta -= period;
+    } else if (delta < -period / 2) {
+      delta += period;
     }
   }
+  if (master->sync0_shift_samples == 0 || delta < master->sync0_send_min) {
+    master->sync0_send_min = delta;
+  }
+  if (master->sync0_shift_samples == 0 || delta > master->sync0_send_max) {
+    master->sync0_send_max = delta;
+  }
+  master->sync0_shift_samples++;
+
+  if (--master->sync0_shift_cycles > 0) {
+    return;
+  }
+
+  offset = ((int64_t)master->sync0_send_phase + master->sync0_send_max + period) % period;
+  *(hal_data->sync0_send_offset) = offset;
+  *(hal_data->sync0_send_jitter) = master->sync0_send_max - master->sync0_send_min;
+  master->sync0_send_offset = offset;
+  if (master->sync0_task != NULL) {
+    lcec_deferred_trigger(master->sync0_task);
+  }
+}
+
+/// @brief Report the measured send time and configure the shifts, outside of the cycle.
+static void lcec_sync0_shift_task(void *arg) {
+  lcec_master_t *master = (lcec_master_t *)arg;
+
+  rtapi_print_msg(RTAPI_MSG_INFO, LCEC_MSG_PFX "master %s: measured send offset %u ns (jitter %u ns) over %d cycles, frame time %u ns\n",
+      master->name, master->sync0_send_offset, *(master->hal_data->sync0_send_jitter), master->sync0_shift_samples, master->frame_time);
+  lcec_apply_sync0_shift(master, master->sync0_send_offset, RTAPI_MSG_INFO);
+}
+
+/// @brief Get the application time for a point in time of the current cycle.
+/// @param now The point in time, from `rtapi_get_time()`.
+/// @param ref Start of the current HAL thread period, only used when the thread is synced to the reference clock.
+static inline uint64_t lcec_app_time(lcec_master_t *master, long long now, long long ref) {
+#ifdef RTAPI_TASK_PLL_SUPPORT
+  if (master->sync_ref_cycles < 0) {
+    return master->app_time_base + master->dc_ref + (now - ref);
+  }
+#endif
+  return master->app_time_base + now;
+}
+
+/// @brief Wait until `send_offset` into the current DC cycle.
+///
+/// If the send phase is still ahead in the current cycle, the function
+/// sleeps until `LCEC_SEND_SPIN_TIME` before it and busy-waits for the
+/// rest.  Otherwise the send phase has already passed; the frame is sent
+/// right away and `send-late` is incremented, rather than waiting into
+/// the next cycle.  Kernel mode always busy-waits.
+static void lcec_wait_send_phase(lcec_master_t *master, long long ref) {
+  lcec_master_data_t *hal_data = master->hal_data;
+  int32_t period = master->app_time_period;
+  long long now, deadline;
+  int32_t pos, wait;
+#ifndef __KERNEL__
+  struct timespec ts;
+#endif
+
+  now = rtapi_get_time();
+  pos = (int32_t)((lcec_app_time(master, now, ref) - master->app_time_start) % period);
+  wait = master->send_offset - pos;
+  if (wait < 0) {
+    (*(hal_data->send_late))++;
+    return;
+  }
+
+  deadline = now + wait;
+#ifndef __KERNEL__
+  if (wait > LCEC_SEND_SPIN_TIME) {
+    ts.tv_sec = 0;
+    ts.tv_nsec = wait - LCEC_SEND_SPIN_TIME;
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, NULL);
+  }
+#endif
+  while (rtapi_get_time() < deadline) {
+    // busy-wait for the exact send time
+  }
+}
+
+/// @brief Store a reference clock time read in this cycle as 64-bit timestamp.
+///
+/// The time was read with the last cycle's frame, so it is extended
+/// around the application time sent with that frame.
+static void lcec_timestamp_ref(lcec_master_t *master, uint32_t ref_time) {
+  lcec_dc_timestamp_t *ts = &master->timestamp;
+
+  if (ts->app_time == 0) {
+    return;
+  }
+  ts->ref_time = ts->app_time + (int32_t)(ref_time - (uint32_t)ts->app_time);
+  ts->ref_app_time = ts->app_time;
 }
 
 /// @brief Write all output pins on a master and its slaves.
 void lcec_write_master(void *arg, long period) {
   lcec_master_t *master = (lcec_master_t *)arg;
-  lcec_slave_t *slave;
+  lcec_master_data_t *hal_data = master->hal_data;
+  lcec_domain_t *domain;
   uint64_t app_time;
   long long now;
-#ifdef RTAPI_TASK_PLL_SUPPORT
+  long long t_start, t_write, t_send;
+  int sample_ref;
+  unsigned int datagrams, data_len;
+  uint32_t dc_sample_time;
+  int dc_sample_valid;
   long long ref;
+#ifdef RTAPI_TASK_PLL_SUPPORT
   uint32_t dc_time;
   int dc_time_valid;
-  lcec_master_data_t *hal_data;
 #endif
 
   // process slaves
-  for (slave = master->first_slave; slave != NULL; slave = slave->next) {
-    if (slave->proc_write != NULL) {
-      slave->proc_write(slave, period);
+  LCEC_TRACE1(write_begin, master->name);
+  t_start = rtapi_get_time();
+  if (master->driver_worker_count > 0) {
+    lcec_run_calls_parallel(
+        master, master->write_chunks, master->write_calls, master->write_serial_first, master->write_call_count, period, 1);
+  } else {
+    // critical slaves first, the others only if read and write are still within the budget
+    lcec_run_calls(master->write_calls, master->write_calls + master->write_noncrit_first, period, 1);
+    if (!master->budget_exceeded) {
+      master->budget_exceeded = lcec_cycle_budget_exceeded(master, master->cycle_used + rtapi_get_time() - t_start);
+    }
+    if (!master->budget_exceeded) {
+      lcec_run_calls(master->write_calls + master->write_noncrit_first, master->write_calls + master->write_call_count, period, 1);
     }
   }
+  t_write = rtapi_get_time();
+  if (master->budget_exceeded) {
+    (*(hal_data->skipped_cycles))++;
+    master->budget_exceeded = 0;
+  }
+
+  // with a bus thread, only pass the outputs on
+  if (master->bus != NULL) {
+    lcec_master_lock(master);
+    lcec_slow_apply(master);
+    lcec_bus_write(master);
+    lcec_master_unlock(master);
+    t_send = rtapi_get_time();
+    lcec_timing_update(&hal_data->timing[LCEC_TIMING_WRITE], t_write - t_start, hal_data->timing_hist_width);
+    lcec_timing_update(&hal_data->timing[LCEC_TIMING_SEND], t_send - t_write, hal_data->timing_hist_width);
+    LCEC_TRACE1(write_end, master->name);
+    return;
+  }
 
-#ifdef RTAPI_TASK_PLL_SUPPORT
   // get reference time
+  ref = 0;
+#ifdef RTAPI_TASK_PLL_SUPPORT
   ref = rtapi_task_pll_get_reference();
+  if (master->sync_ref_cycles < 0) {
+    master->dc_ref += period;
+  }
 #endif
 
+  // wait for the configured send phase
+  if (master->send_offset >= 0) {
+    lcec_wait_send_phase(master, ref);
+  }
+
   // send process data
-  rtapi_mutex_get(&master->mutex);
-  ecrt_domain_queue(master->domain);
+  datagrams = 0;
+  data_len = 0;
+  lcec_master_lock(master);
+  lcec_slow_apply(master);
+  for (domain = master->first_domain; domain != NULL; domain = domain->next) {
+    if (domain == master->input_domain && master->send_inputs_used) {
+      continue;
+    }
+    if (domain->pdo_entry_count > 0 && domain->cycle_cnt == 0) {
+      ecrt_domain_queue(domain->domain);
+      domain->queued = 1;
+      datagrams += domain->datagram_count;
+      data_len += domain->data_size;
+    }
+    if (++domain->cycle_cnt >= domain->cycle_divisor) {
+      domain->cycle_cnt = 0;
+    }
+  }
 
   // update application time
   now = rtapi_get_time();
-#ifdef RTAPI_TASK_PLL_SUPPORT
-  if (master->sync_ref_cycles >= 0) {
-    app_time = master->app_time_base + now;
-  } else {
-    master->dc_ref += period;
-    app_time = master->app_time_base + master->dc_ref + (now - ref);
-  }
-#else
-  app_time = master->app_time_base + now;
-#endif
-
+  app_time = lcec_app_time(master, now, ref);
   ecrt_master_application_time(master->master, app_time);
 
   // sync ref clock to master
@@ -1248,6 +2795,7 @@ void lcec_write_master(void *arg, long period) {
     if (master->sync_ref_cnt == 0) {
       master->sync_ref_cnt = master->sync_ref_cycles;
       ecrt_master_sync_reference_clock(master->master);
+      datagrams++;
     }
     master->sync_ref_cnt--;
   }
@@ -1263,17 +2811,71 @@ void lcec_write_master(void *arg, long period) {
   }
 #endif
 
+  // sample ref clock for DC statistics, the PLL reads it every cycle anyway
+  sample_ref = 1;
+#ifdef RTAPI_TASK_PLL_SUPPORT
+  sample_ref = (master->sync_ref_cycles >= 0);
+#endif
+  dc_sample_valid = 0;
+  if (sample_ref) {
+    if (hal_data->dc_stats.sample_cnt == 0) {
+      hal_data->dc_stats.sample_cnt = (hal_data->dc_stats.sample_cycles > 0) ? hal_data->dc_stats.sample_cycles : 1;
+      dc_sample_valid = (ecrt_master_reference_clock_time(master->master, &dc_sample_time) == 0);
+    }
+    hal_data->dc_stats.sample_cnt--;
+  }
+
+  // extend the ref clock time, it belongs to the application time of the last cycle
+  if (dc_sample_valid) {
+    lcec_timestamp_ref(master, dc_sample_time);
+  }
+#ifdef RTAPI_TASK_PLL_SUPPORT
+  if (dc_time_valid) {
+    lcec_timestamp_ref(master, dc_time);
+  }
+#endif
+
   // sync slaves to ref clock
   ecrt_master_sync_slave_clocks(master->master);
 
+  // measure send time for sync0Shift="auto", once all slaves are running
+  if (master->sync0_shift_auto && master->sync0_shift_cycles > 0 && *(hal_data->all_op)) {
+    lcec_sync0_shift_sample(master, app_time + (rtapi_get_time() - now));
+  }
+
   // send domain data
+  LCEC_TRACE1(write_send, master->name);
   ecrt_master_send(master->master);
-  rtapi_mutex_give(&master->mutex);
+  master->send_time = rtapi_get_time();
+  lcec_master_unlock(master);
+  t_send = rtapi_get_time();
+  LCEC_TRACE1(write_end, master->name);
+
+  // update frame size pins, counting the slave clock sync datagram
+  *(hal_data->frame_datagrams) = datagrams + 1;
+  *(hal_data->frame_data_len) = data_len;
+
+  // update timestamps for the next cycle's drivers
+  master->timestamp.app_time = app_time;
+  master->app_time_clock = now;
+  lcec_set_u64_pins(hal_data->dc_app_time_lo, hal_data->dc_app_time_hi, app_time);
+  lcec_set_u64_pins(hal_data->dc_ref_time_lo, hal_data->dc_ref_time_hi, master->timestamp.ref_time);
+
+  // update timing statistics
+  lcec_timing_update(&hal_data->timing[LCEC_TIMING_WRITE], t_write - t_start, hal_data->timing_hist_width);
+  lcec_timing_update(&hal_data->timing[LCEC_TIMING_SEND], t_send - t_write, hal_data->timing_hist_width);
+
+  // update DC statistics, the ref clock time belongs to the application time of the last cycle
+  if (hal_data->dc_stats.resync_time == 0) {
+    hal_data->dc_stats.resync_time = now;
+  }
+  if (dc_sample_valid && master->app_time_last != 0) {
+    lcec_dc_stats_update(&hal_data->dc_stats, (int32_t)(master->app_time_last - dc_sample_time));
+  }
 
 #ifdef RTAPI_TASK_PLL_SUPPORT
   // BANG-BANG controller for master thread PLL sync
   // this part is done after ecrt_master_send() to reduce jitter
-  hal_data = master->hal_data;
   *(hal_data->pll_err) = 0;
   *(hal_data->pll_out) = 0;
   // the first read dc_time value semms to be invalid, so wait for two successive succesfull reads
@@ -1287,13 +2889,152 @@ void lcec_write_master(void *arg, long period) {
       dc_time_valid = 0;
       // increment reset counter to document this event
       (*(hal_data->pll_reset_cnt))++;
+      hal_data->dc_stats.resync_time = now;
     } else {
-      *(hal_data->pll_out) = (*(hal_data->pll_err) < 0) ? -(hal_data->pll_step) : (hal_data->pll_step);
+      lcec_dc_stats_update(&hal_data->dc_stats, *(hal_data->pll_err));
+      if (master->pll_mode == lcecPllModePI) {
+        *(hal_data->pll_out) = lcec_pll_pi(master, *(hal_data->pll_err));
+      } else {
+        *(hal_data->pll_out) = (*(hal_data->pll_err) < 0) ? -(hal_data->pll_step) : (hal_data->pll_step);
+      }
     }
+  } else if (master->pll_mode == lcecPllModePI) {
+    // keep the learned frequency offset while there is no valid error
+    *(hal_data->pll_out) = lcec_pll_limit(master, master->pll_integral);
   }
 
+  // lock detection
+  if (dc_time_valid && master->dc_time_valid_last && abs(*(hal_data->pll_err)) <= hal_data->pll_lock_window) {
+    if (master->pll_lock_cnt < LCEC_PLL_LOCK_CYCLES) {
+      master->pll_lock_cnt++;
+    }
+  } else {
+    master->pll_lock_cnt = 0;
+  }
+  *(hal_data->pll_locked) = (master->pll_lock_cnt >= LCEC_PLL_LOCK_CYCLES);
+
   rtapi_task_pll_set_correction(*(hal_data->pll_out));
-  master->app_time_last = (uint32_t)app_time;
   master->dc_time_valid_last = dc_time_valid;
 #endif
+
+  master->app_time_last = (uint32_t)app_time;
+  *(hal_data->dc_stats.time_since_resync) = (now - hal_data->dc_stats.resync_time) * 1e-9;
+}
+
+/// @brief Read and write all pins of a master and its slaves in one function.
+///
+/// Receives the frame sent in the last cycle, runs the slaves' read and
+/// write callbacks and sends the next frame.  With `sendOffset`
+/// configured, the frame is sent at a fixed time into the DC cycle, no
+/// matter how long the callbacks took.
+void lcec_cycle_master(void *arg, long period) {
+  lcec_read_master(arg, period);
+  lcec_write_master(arg, period);
+}
+
+/// @brief Copy the outputs of the low priority slaves into the process data.
+///
+/// Must be called with the master's lock held, before the process data
+/// is sent.  Only the bytes changed by `write-slow` are copied, so the
+/// other slaves' outputs are left alone.
+static void lcec_slow_apply(lcec_master_t *master) {
+  uint8_t *pd = master->process_data;
+  int i;
+
+  if (!master->slow_out_pending) {
+    return;
+  }
+
+  for (i = 0; i < master->process_data_len; i++) {
+    if (master->slow_out_mask[i]) {
+      pd[i] = master->slow_out[i];
+      master->slow_out_mask[i] = 0;
+    }
+  }
+  master->slow_out_pending = 0;
+}
+
+/// @brief Run the read callbacks of a master's low priority slaves.
+///
+/// This is meant to run in a slower HAL thread than `lcec_read_master`.
+/// The slaves see a copy of the inputs of the last exchange done by the
+/// fast functions, taken under the master's lock.
+void lcec_read_slow_master(void *arg, long period) {
+  lcec_master_t *master = (lcec_master_t *)arg;
+  int len = master->process_data_len;
+  int i;
+
+  if (master->slow_data == NULL) {
+    return;
+  }
+
+  // take the inputs, keeping the outputs the fast functions haven't sent yet
+  lcec_master_lock(master);
+  memcpy(master->slow_data, master->process_data, len);
+  if (master->slow_out_pending) {
+    for (i = 0; i < len; i++) {
+      if (master->slow_out_mask[i]) {
+        master->slow_data[i] = master->slow_out[i];
+      }
+    }
+  }
+  lcec_master_unlock(master);
+  memcpy(master->slow_snapshot, master->slow_data, len);
+
+  lcec_run_calls(master->slow_read_calls, master->slow_read_calls + master->slow_read_call_count, period, 0);
+}
+
+/// @brief Run the write callbacks of a master's low priority slaves.
+///
+/// The changed outputs are handed over under the master's lock and sent
+/// with the next exchange of the fast functions.
+void lcec_write_slow_master(void *arg, long period) {
+  lcec_master_t *master = (lcec_master_t *)arg;
+  int i;
+
+  if (master->slow_data == NULL) {
+    return;
+  }
+
+  lcec_run_calls(master->slow_write_calls, master->slow_write_calls + master->slow_write_call_count, period, 1);
+
+  lcec_master_lock(master);
+  for (i = 0; i < master->process_data_len; i++) {
+    if (master->slow_data[i] != master->slow_snapshot[i]) {
+      master->slow_out[i] = master->slow_data[i];
+      master->slow_out_mask[i] = 1;
+      master->slow_snapshot[i] = master->slow_data[i];
+      master->slow_out_pending = 1;
+    }
+  }
+  lcec_master_unlock(master);
+}
+
+/// @brief Send the input domain of a master with `splitDomains="true"`.
+///
+/// Once this function runs, `lcec_write_master()` only sends the
+/// outputs.  The inputs are received by the next `lcec_read_master()`,
+/// so this should run early enough for the frame to return before it.
+void lcec_send_inputs_master(void *arg, long period) {
+  lcec_master_t *master = (lcec_master_t *)arg;
+  lcec_domain_t *domain = master->input_domain;
+
+  // the bus thread exchanges all domains
+  if (domain->pdo_entry_count == 0 || master->bus != NULL) {
+    return;
+  }
+  master->send_inputs_used = 1;
+
+  // honor the domain's cycleDivisor, like lcec_write_master() does for the other domains
+  if (domain->cycle_cnt == 0) {
+    lcec_master_lock(master);
+    ecrt_domain_queue(domain->domain);
+    domain->queued = 1;
+    ecrt_master_send(master->master);
+    master->send_time = rtapi_get_time();
+    lcec_master_unlock(master);
+  }
+  if (++domain->cycle_cnt >= domain->cycle_divisor) {
+    domain->cycle_cnt = 0;
+  }
 }
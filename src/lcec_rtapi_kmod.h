@@ -22,6 +22,7 @@
 #define _LCEC_RTAPI_KMOD_H_
 
 #include <linux/jiffies.h>
+#include <linux/ktime.h>
 #include <linux/math64.h>
 #include <linux/sched.h>
 #include <linux/slab.h>
@@ -35,6 +36,8 @@
 #define LCEC_MS_TO_TICKS(x) (HZ * x / 1000)
 #define lcec_get_ticks()    ((long)jiffies)
 
+#define lcec_get_time_ns() ((long long)ktime_get_ns())
+
 #define lcec_schedule() schedule()
 
 static inline long long lcec_mod_64(long long val, unsigned long div) {
@@ -43,4 +46,6 @@ static inline long long lcec_mod_64(long long val, unsigned long div) {
   return rem;
 }
 
+static inline long long lcec_div_64(long long val, unsigned long div) { return div_s64(val, div); }
+
 #endif
@@ -43,8 +43,16 @@ static inline long lcec_get_ticks(void) {
   return ((long)(tp.tv_sec * 100LL)) + (tp.tv_nsec / 10000000L);
 }
 
+// like rtapi_get_time(), but also available to code linked into lcec_conf
+static inline long long lcec_get_time_ns(void) {
+  struct timespec tp;
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return tp.tv_sec * 1000000000LL + tp.tv_nsec;
+}
+
 #define lcec_schedule() sched_yield()
 
 static inline long long lcec_mod_64(long long val, unsigned long div) { return val % div; }
+static inline long long lcec_div_64(long long val, unsigned long div) { return val / div; }
 
 #endif
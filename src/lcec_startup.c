@@ -0,0 +1,181 @@
+//
+//    Copyright (C) 2024 The LinuxCNC-Ethercat authors
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+/// @file
+/// @brief Startup timeline and per-slave configuration cost.
+///
+/// `rtapi_app_main()` calls `lcec_startup_mark()` at the end of each
+/// startup phase.  The cost of each slave is recorded in
+/// `slave->startup` while the slave is initialized, and by
+/// `lcec_read_sdo()`/`lcec_write_sdo()`.  The read function records
+/// when all slaves of a master have reached OP.
+///
+/// At the end of `rtapi_app_main()` a summary is logged, and if
+/// `startupReport` is set on `<masters>`, a JSON report is written.  The
+/// report is written again on exit, then including the time until OP.
+/// Reports are not supported in kernel mode.
+
+#ifndef __KERNEL__
+#include <stdio.h>
+#endif
+
+#include "lcec.h"
+
+// number of slaves listed in the summary
+#define LCEC_STARTUP_TOP_SLAVES 5
+
+static const char *phase_names[LCEC_STARTUP_PHASE_COUNT] = {
+    "parse",
+    "request",
+    "slaves",
+    "setup",
+    "register",
+    "activate",
+    "hal",
+};
+
+/// @brief Convert ns to ms, for messages.
+static inline int lcec_startup_ms(long long ns) { return (int)lcec_div_64(ns, 1000000); }
+
+/// @brief Record the end of a startup phase.
+///
+/// Everything since the end of the previous phase is counted for
+/// `phase`.  Phases that are repeated per master add up.
+void lcec_startup_mark(lcec_startup_t *startup, lcec_startup_phase_t phase) {
+  long long now = rtapi_get_time();
+
+  startup->phases[phase] += now - startup->last;
+  startup->last = now;
+}
+
+/// @brief Log the startup timeline and the slowest slaves.
+void lcec_startup_print(const lcec_startup_t *startup, struct lcec_master *first_master) {
+  lcec_master_t *master;
+  lcec_slave_t *slave, *top[LCEC_STARTUP_TOP_SLAVES];
+  long long cost;
+  int i, j;
+
+  rtapi_print_msg(RTAPI_MSG_INFO, LCEC_MSG_PFX "startup took %d ms\n", lcec_startup_ms(startup->last - startup->start));
+  for (i = 0; i < LCEC_STARTUP_PHASE_COUNT; i++) {
+    rtapi_print_msg(RTAPI_MSG_INFO, LCEC_MSG_PFX "  %-8s %6d ms\n", phase_names[i], lcec_startup_ms(startup->phases[i]));
+  }
+
+  // find the slowest slaves, by configuration plus proc_init time
+  memset(top, 0, sizeof(top));
+  for (master = first_master; master != NULL; master = master->next) {
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+      cost = slave->startup.config_time + slave->startup.init_time;
+      for (i = 0; i < LCEC_STARTUP_TOP_SLAVES; i++) {
+        if (top[i] == NULL || cost > top[i]->startup.config_time + top[i]->startup.init_time) {
+          for (j = LCEC_STARTUP_TOP_SLAVES - 1; j > i; j--) {
+            top[j] = top[j - 1];
+          }
+          top[i] = slave;
+          break;
+        }
+      }
+    }
+  }
+
+  for (i = 0; i < LCEC_STARTUP_TOP_SLAVES && top[i] != NULL; i++) {
+    slave = top[i];
+    rtapi_print_msg(RTAPI_MSG_INFO, LCEC_MSG_PFX "  slave %s.%s (%s): config %d ms, proc_init %d ms, %d SDO transfers taking %d ms\n",
+        slave->master->name, slave->name, slave->type_name, lcec_startup_ms(slave->startup.config_time),
+        lcec_startup_ms(slave->startup.init_time), slave->startup.sdo_count, lcec_startup_ms(slave->startup.sdo_time));
+  }
+}
+
+#ifndef __KERNEL__
+
+/// @brief Write a JSON string, escaping quotes and backslashes.
+static void lcec_startup_write_str(FILE *f, const char *str) {
+  fputc('"', f);
+  for (; *str != 0; str++) {
+    if (*str == '"' || *str == '\\') {
+      fputc('\\', f);
+    }
+    fputc(*str, f);
+  }
+  fputc('"', f);
+}
+
+/// @brief Write the startup report to the file configured with `startupReport`.
+///
+/// All times are in ns.  `op_time` is null until all slaves of the
+/// master have reached OP.
+/// @return 0 on success or if no report is configured, negative for error.
+int lcec_startup_write(const lcec_startup_t *startup, struct lcec_master *first_master) {
+  lcec_master_t *master;
+  lcec_slave_t *slave;
+  FILE *f;
+  int i;
+
+  if (startup->report[0] == 0) {
+    return 0;
+  }
+
+  f = fopen(startup->report, "w");
+  if (f == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "unable to write startup report %s\n", startup->report);
+    return -EIO;
+  }
+
+  fprintf(f, "{\n  \"total\": %lld,\n  \"phases\": {", startup->last - startup->start);
+  for (i = 0; i < LCEC_STARTUP_PHASE_COUNT; i++) {
+    fprintf(f, "%s\"%s\": %lld", (i > 0) ? ", " : "", phase_names[i], startup->phases[i]);
+  }
+  fprintf(f, "},\n  \"masters\": [");
+
+  for (master = first_master; master != NULL; master = master->next) {
+    fprintf(f, "%s\n    {\"name\": ", (master != first_master) ? "," : "");
+    lcec_startup_write_str(f, master->name);
+    if (master->op_time > 0) {
+      fprintf(f, ", \"op_time\": %lld, \"slaves\": [", master->op_time);
+    } else {
+      fprintf(f, ", \"op_time\": null, \"slaves\": [");
+    }
+
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+      fprintf(f, "%s\n      {\"name\": ", (slave != master->first_slave) ? "," : "");
+      lcec_startup_write_str(f, slave->name);
+      fprintf(f, ", \"type\": ");
+      lcec_startup_write_str(f, slave->type_name);
+      fprintf(f, ", \"index\": %d, \"config_time\": %lld, \"init_time\": %lld, \"sdo_count\": %d, \"sdo_time\": %lld}", slave->index,
+          slave->startup.config_time, slave->startup.init_time, slave->startup.sdo_count, slave->startup.sdo_time);
+    }
+    fprintf(f, "]}");
+  }
+  fprintf(f, "\n  ]\n}\n");
+
+  if (fclose(f) != 0) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "unable to write startup report %s\n", startup->report);
+    return -EIO;
+  }
+  return 0;
+}
+
+#else
+
+int lcec_startup_write(const lcec_startup_t *startup, struct lcec_master *first_master) {
+  if (startup->report[0] != 0) {
+    rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "startupReport ignored, not supported in kernel mode\n");
+  }
+  return 0;
+}
+
+#endif
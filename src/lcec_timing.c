@@ -0,0 +1,368 @@
+//
+//    Copyright (C) 2024 The LinuxCNC-Ethercat authors
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+/// @file
+/// @brief Execution time statistics for the realtime read/write cycle.
+
+#include "lcec.h"
+
+extern int lcec_comp_id;
+
+// weight of a new sample in the rolling mean is 1/2^LCEC_TIMING_MEAN_SHIFT
+#define LCEC_TIMING_MEAN_SHIFT 6
+
+static const lcec_pindesc_t timing_pins[] = {
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, last), "%s.timing.%s.last"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, min), "%s.timing.%s.min"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, max), "%s.timing.%s.max"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, mean), "%s.timing.%s.mean"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, hist[0]), "%s.timing.%s.hist-0"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, hist[1]), "%s.timing.%s.hist-1"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, hist[2]), "%s.timing.%s.hist-2"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, hist[3]), "%s.timing.%s.hist-3"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, hist[4]), "%s.timing.%s.hist-4"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, hist[5]), "%s.timing.%s.hist-5"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, hist[6]), "%s.timing.%s.hist-6"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_timing_stat_t, hist[7]), "%s.timing.%s.hist-7"},
+    {HAL_TYPE_UNSPECIFIED, HAL_DIR_UNSPECIFIED, -1, NULL},
+};
+
+/// @brief Export the HAL pins for one timed phase.
+/// @param stat The statistics to export.
+/// @param pfx The pin prefix, usually `lcec.<master>`.
+/// @param phase The name of the phase, used in the pin names.
+/// @return 0 if successful, negative for error.
+int lcec_timing_init_hal(lcec_timing_stat_t *stat, const char *pfx, const char *phase) {
+  int err;
+
+  if ((err = lcec_pin_newf_list(stat, timing_pins, pfx, phase)) != 0) {
+    return err;
+  }
+
+  lcec_timing_reset(stat);
+  return 0;
+}
+
+/// @brief Clear all statistics for one timed phase.
+void lcec_timing_reset(lcec_timing_stat_t *stat) {
+  int i;
+
+  *(stat->last) = 0;
+  *(stat->min) = 0;
+  *(stat->max) = 0;
+  *(stat->mean) = 0;
+  for (i = 0; i < LCEC_TIMING_HIST_BUCKETS; i++) {
+    *(stat->hist[i]) = 0;
+  }
+  stat->mean_acc = 0;
+  stat->valid = 0;
+}
+
+/// @brief Add one sample to the statistics of a timed phase.
+/// @param stat The statistics to update.
+/// @param duration The measured duration, in ns.
+/// @param hist_width The width of one histogram bucket, in ns.
+void lcec_timing_update(lcec_timing_stat_t *stat, long long duration, hal_u32_t hist_width) {
+  hal_u32_t val;
+  hal_u32_t bucket;
+
+  // clamp to pin range
+  if (duration < 0) {
+    val = 0;
+  } else if (duration > 0xffffffffLL) {
+    val = 0xffffffff;
+  } else {
+    val = duration;
+  }
+
+  *(stat->last) = val;
+  if (!stat->valid) {
+    *(stat->min) = val;
+    *(stat->max) = val;
+    stat->mean_acc = (uint64_t)val << LCEC_TIMING_MEAN_SHIFT;
+    stat->valid = 1;
+  } else {
+    if (val < *(stat->min)) {
+      *(stat->min) = val;
+    }
+    if (val > *(stat->max)) {
+      *(stat->max) = val;
+    }
+    stat->mean_acc -= stat->mean_acc >> LCEC_TIMING_MEAN_SHIFT;
+    stat->mean_acc += val;
+  }
+  *(stat->mean) = stat->mean_acc >> LCEC_TIMING_MEAN_SHIFT;
+
+  // update histogram, the last bucket also counts everything above it
+  bucket = (hist_width > 0) ? val / hist_width : LCEC_TIMING_HIST_BUCKETS - 1;
+  if (bucket >= LCEC_TIMING_HIST_BUCKETS) {
+    bucket = LCEC_TIMING_HIST_BUCKETS - 1;
+  }
+  (*(stat->hist[bucket]))++;
+}
+
+static const lcec_pindesc_t dc_stats_pins[] = {
+    {HAL_S32, HAL_OUT, offsetof(lcec_dc_stat_t, err_min), "%s.dc-err-min"},
+    {HAL_S32, HAL_OUT, offsetof(lcec_dc_stat_t, err_max), "%s.dc-err-max"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_dc_stat_t, err_rms), "%s.dc-err-rms"},
+    {HAL_U32, HAL_OUT, offsetof(lcec_dc_stat_t, violations), "%s.dc-window-violations"},
+    {HAL_FLOAT, HAL_OUT, offsetof(lcec_dc_stat_t, time_since_resync), "%s.dc-time-since-resync"},
+    {HAL_TYPE_UNSPECIFIED, HAL_DIR_UNSPECIFIED, -1, NULL},
+};
+
+static const lcec_pindesc_t dc_stats_params[] = {
+    {HAL_U32, HAL_RW, offsetof(lcec_dc_stat_t, window), "%s.dc-stats-window"},
+    {HAL_U32, HAL_RW, offsetof(lcec_dc_stat_t, sync_window), "%s.dc-sync-window"},
+    {HAL_U32, HAL_RW, offsetof(lcec_dc_stat_t, sample_cycles), "%s.dc-sample-cycles"},
+    {HAL_TYPE_UNSPECIFIED, HAL_DIR_UNSPECIFIED, -1, NULL},
+};
+
+/// @brief Integer square root, rounded down.
+static uint32_t lcec_isqrt(uint64_t val) {
+  uint64_t res = 0;
+  uint64_t bit = 1ULL << 62;
+
+  while (bit > val) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (val >= res + bit) {
+      val -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return res;
+}
+
+/// @brief Export the HAL pins and params for the reference clock error statistics.
+/// @param stat The statistics to export.
+/// @param pfx The pin prefix, usually `lcec.<master>`.
+/// @return 0 if successful, negative for error.
+int lcec_dc_stats_init_hal(lcec_dc_stat_t *stat, const char *pfx) {
+  int err;
+
+  if ((err = lcec_pin_newf_list(stat, dc_stats_pins, pfx)) != 0) {
+    return err;
+  }
+  if ((err = lcec_param_newf_list(stat, dc_stats_params, pfx)) != 0) {
+    return err;
+  }
+
+  lcec_dc_stats_reset(stat);
+  return 0;
+}
+
+/// @brief Clear the reference clock error statistics.
+void lcec_dc_stats_reset(lcec_dc_stat_t *stat) {
+  *(stat->err_min) = 0;
+  *(stat->err_max) = 0;
+  *(stat->err_rms) = 0;
+  *(stat->violations) = 0;
+  stat->sq_sum = 0;
+  stat->count = 0;
+}
+
+/// @brief Add one sample to the reference clock error statistics.
+///
+/// Min, max and RMS are published at the end of every window of
+/// `dc-stats-window` samples.
+/// @param err The error between the application time and the reference clock, in ns.
+void lcec_dc_stats_update(lcec_dc_stat_t *stat, int32_t err) {
+  uint32_t abs_err = (err < 0) ? -(int64_t)err : err;
+  uint64_t sq_err = (uint64_t)abs_err * abs_err;
+
+  if (abs_err > stat->sync_window) {
+    (*(stat->violations))++;
+  }
+
+  if (stat->count == 0 || err < stat->min) {
+    stat->min = err;
+  }
+  if (stat->count == 0 || err > stat->max) {
+    stat->max = err;
+  }
+  // saturate instead of overflowing on huge errors
+  stat->sq_sum = (stat->sq_sum + sq_err < stat->sq_sum) ? UINT64_MAX : stat->sq_sum + sq_err;
+  stat->count++;
+
+  if (stat->count >= stat->window) {
+    *(stat->err_min) = stat->min;
+    *(stat->err_max) = stat->max;
+    *(stat->err_rms) = lcec_isqrt(stat->sq_sum / stat->count);
+    stat->sq_sum = 0;
+    stat->count = 0;
+  }
+}
+
+static const lcec_pindesc_t profile_params[] = {
+    {HAL_U32, HAL_RO, offsetof(lcec_slave_profile_t, read.max), "%s.%s.%s.profile-read-max"},
+    {HAL_U32, HAL_RO, offsetof(lcec_slave_profile_t, read.mean), "%s.%s.%s.profile-read-mean"},
+    {HAL_U32, HAL_RO, offsetof(lcec_slave_profile_t, write.max), "%s.%s.%s.profile-write-max"},
+    {HAL_U32, HAL_RO, offsetof(lcec_slave_profile_t, write.mean), "%s.%s.%s.profile-write-mean"},
+    {HAL_TYPE_UNSPECIFIED, HAL_DIR_UNSPECIFIED, -1, NULL},
+};
+
+static int profile_shmem_id = -1;
+
+/// @brief Allocate and export the callback profiling params for a slave.
+/// @return 0 if successful, negative for error.
+int lcec_profile_init_hal(struct lcec_slave *slave) {
+  lcec_slave_profile_t *profile;
+  int err;
+
+  if ((profile = hal_malloc(sizeof(lcec_slave_profile_t))) == NULL) {
+    rtapi_print_msg(
+        RTAPI_MSG_ERR, LCEC_MSG_PFX "hal_malloc() for %s.%s.%s profile failed\n", LCEC_MODULE_NAME, slave->master->name, slave->name);
+    return -EIO;
+  }
+  memset(profile, 0, sizeof(lcec_slave_profile_t));
+
+  if ((err = lcec_param_newf_list(profile, profile_params, LCEC_MODULE_NAME, slave->master->name, slave->name)) != 0) {
+    return err;
+  }
+
+  slave->profile = profile;
+  return 0;
+}
+
+/// @brief Clear the callback profiling statistics of a slave.
+void lcec_profile_reset(lcec_slave_profile_t *profile) {
+  memset(&profile->read, 0, sizeof(lcec_profile_stat_t));
+  memset(&profile->write, 0, sizeof(lcec_profile_stat_t));
+}
+
+/// @brief Add one sample to a slave callback's statistics.
+/// @param stat The statistics to update.
+/// @param duration The measured duration, in ns.
+void lcec_profile_update(lcec_profile_stat_t *stat, long long duration) {
+  hal_u32_t val;
+
+  // clamp to param range
+  if (duration < 0) {
+    val = 0;
+  } else if (duration > 0xffffffffLL) {
+    val = 0xffffffff;
+  } else {
+    val = duration;
+  }
+
+  if (!stat->valid) {
+    stat->max = val;
+    stat->mean_acc = (uint64_t)val << LCEC_TIMING_MEAN_SHIFT;
+    stat->valid = 1;
+  } else {
+    if (val > stat->max) {
+      stat->max = val;
+    }
+    stat->mean_acc -= stat->mean_acc >> LCEC_TIMING_MEAN_SHIFT;
+    stat->mean_acc += val;
+  }
+  stat->mean = stat->mean_acc >> LCEC_TIMING_MEAN_SHIFT;
+}
+
+/// @brief Create the shared memory that `lcec_top` reads profiling data from.
+///
+/// One record is assigned to every slave that has profiling enabled.
+/// Nothing is created if no master has `profileSlaves` set.
+/// @return 0 if successful, negative for error.
+int lcec_profile_init_shmem(struct lcec_master *first_master) {
+  struct lcec_master *master;
+  struct lcec_slave *slave;
+  lcec_profile_header_t *header;
+  lcec_profile_record_t *record;
+  void *shmem_ptr;
+  int count;
+
+  // count profiled slaves
+  count = 0;
+  for (master = first_master; master != NULL; master = master->next) {
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+      if (slave->profile != NULL) {
+        count++;
+      }
+    }
+  }
+  if (count == 0) {
+    return 0;
+  }
+
+  profile_shmem_id =
+      rtapi_shmem_new(LCEC_PROFILE_SHMEM_KEY, lcec_comp_id, sizeof(lcec_profile_header_t) + count * sizeof(lcec_profile_record_t));
+  if (profile_shmem_id < 0) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "couldn't allocate profiling shared memory\n");
+    return -EIO;
+  }
+  if (lcec_rtapi_shmem_getptr(profile_shmem_id, &shmem_ptr) < 0) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "couldn't map profiling shared memory\n");
+    lcec_profile_exit_shmem();
+    return -EIO;
+  }
+
+  // assign records
+  header = shmem_ptr;
+  record = shmem_ptr + sizeof(lcec_profile_header_t);
+  memset(record, 0, count * sizeof(lcec_profile_record_t));
+  for (master = first_master; master != NULL; master = master->next) {
+    for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+      if (slave->profile != NULL) {
+        strncpy(record->master_name, master->name, LCEC_CONF_STR_MAXLEN - 1);
+        strncpy(record->slave_name, slave->name, LCEC_CONF_STR_MAXLEN - 1);
+        strncpy(record->type_name, slave->type_name, LCEC_CONF_STR_MAXLEN - 1);
+        slave->profile->record = record++;
+      }
+    }
+  }
+  header->count = count;
+  header->magic = LCEC_PROFILE_SHMEM_MAGIC;
+
+  return 0;
+}
+
+/// @brief Release the profiling shared memory.
+void lcec_profile_exit_shmem(void) {
+  if (profile_shmem_id >= 0) {
+    rtapi_shmem_delete(profile_shmem_id, lcec_comp_id);
+    profile_shmem_id = -1;
+  }
+}
+
+/// @brief Copy the profiling statistics of a master's slaves into shared memory.
+void lcec_profile_publish(struct lcec_master *master) {
+  struct lcec_slave *slave;
+  lcec_profile_record_t *record;
+
+  for (slave = master->first_slave; slave != NULL; slave = slave->next) {
+    if (slave->profile == NULL || (record = slave->profile->record) == NULL) {
+      continue;
+    }
+
+    // readers retry while seq is odd or changes during their copy
+    record->seq++;
+    __sync_synchronize();
+    record->read_max = slave->profile->read.max;
+    record->read_mean = slave->profile->read.mean;
+    record->write_max = slave->profile->write.max;
+    record->write_mean = slave->profile->write.mean;
+    __sync_synchronize();
+    record->seq++;
+  }
+}
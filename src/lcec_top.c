@@ -0,0 +1,229 @@
+//
+//    Copyright (C) 2024 The LinuxCNC-Ethercat authors
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+/// @file
+/// @brief Code for the `lcec_top` tool, which lists the slaves with the most expensive read/write callbacks.
+///
+/// This reads the profiling shared memory that the realtime module
+/// fills in for masters with `profileSlaves="true"`.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hal.h"
+#include "lcec.h"
+#include "lcec_rtapi.h"
+#include "rtapi.h"
+
+#define DEFAULT_TOP_COUNT 20
+
+static char *modname = "lcec_top";
+
+static volatile int exit_flag = 0;
+
+typedef struct {
+  char type_name[LCEC_CONF_STR_MAXLEN];
+  int count;
+  uint64_t mean_sum;
+  uint32_t max;
+} type_summary_t;
+
+static void exitHandler(int sig) { exit_flag = 1; }
+
+static uint32_t record_cost(const lcec_profile_record_t *rec) { return rec->read_mean + rec->write_mean; }
+
+static int compare_records(const void *a, const void *b) {
+  uint32_t ca = record_cost(a);
+  uint32_t cb = record_cost(b);
+
+  return (ca < cb) - (ca > cb);
+}
+
+static int compare_types(const void *a, const void *b) {
+  const type_summary_t *ta = a;
+  const type_summary_t *tb = b;
+
+  return (ta->mean_sum < tb->mean_sum) - (ta->mean_sum > tb->mean_sum);
+}
+
+/// @brief Take a consistent copy of all records.
+static void snapshot(lcec_profile_record_t *dst, lcec_profile_record_t *src, int count) {
+  uint32_t seq;
+  int i;
+
+  for (i = 0; i < count; i++) {
+    do {
+      while ((seq = src[i].seq) & 1) {
+        sched_yield();
+      }
+      __sync_synchronize();
+      memcpy(&dst[i], &src[i], sizeof(lcec_profile_record_t));
+      __sync_synchronize();
+    } while (seq != src[i].seq);
+  }
+}
+
+static void print_report(lcec_profile_record_t *records, int count, type_summary_t *types, int top_count) {
+  int i, j, type_count;
+  uint32_t max;
+
+  qsort(records, count, sizeof(lcec_profile_record_t), compare_records);
+
+  printf("%-12s %-24s %-16s %10s %10s %10s %10s\n", "MASTER", "SLAVE", "TYPE", "READ-MEAN", "READ-MAX", "WRITE-MEAN", "WRITE-MAX");
+  for (i = 0; i < count && i < top_count; i++) {
+    printf("%-12s %-24s %-16s %10u %10u %10u %10u\n", records[i].master_name, records[i].slave_name, records[i].type_name,
+        records[i].read_mean, records[i].read_max, records[i].write_mean, records[i].write_max);
+  }
+
+  // summarize by type
+  type_count = 0;
+  for (i = 0; i < count; i++) {
+    for (j = 0; j < type_count; j++) {
+      if (strcmp(types[j].type_name, records[i].type_name) == 0) {
+        break;
+      }
+    }
+    if (j == type_count) {
+      memset(&types[j], 0, sizeof(type_summary_t));
+      strncpy(types[j].type_name, records[i].type_name, LCEC_CONF_STR_MAXLEN - 1);
+      type_count++;
+    }
+    types[j].count++;
+    types[j].mean_sum += record_cost(&records[i]);
+    max = records[i].read_max + records[i].write_max;
+    if (max > types[j].max) {
+      types[j].max = max;
+    }
+  }
+  qsort(types, type_count, sizeof(type_summary_t), compare_types);
+
+  printf("\n%-16s %6s %12s %12s\n", "TYPE", "COUNT", "TOTAL-MEAN", "WORST-MAX");
+  for (j = 0; j < type_count; j++) {
+    printf("%-16s %6d %12llu %12u\n", types[j].type_name, types[j].count, (unsigned long long)types[j].mean_sum, types[j].max);
+  }
+  printf("\nAll times in ns.\n");
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: %s [-n count] [-i interval]\n", modname);
+  fprintf(stderr, "  -n count     number of slaves to list (default %d)\n", DEFAULT_TOP_COUNT);
+  fprintf(stderr, "  -i interval  repeat every interval seconds until interrupted\n");
+}
+
+int main(int argc, char **argv) {
+  int ret = 1;
+  int opt;
+  int top_count = DEFAULT_TOP_COUNT;
+  int interval = 0;
+  int comp_id;
+  int shmem_id;
+  void *shmem_ptr;
+  lcec_profile_header_t *header;
+  int count;
+  lcec_profile_record_t *records = NULL;
+  type_summary_t *types = NULL;
+
+  while ((opt = getopt(argc, argv, "n:i:h")) != -1) {
+    switch (opt) {
+      case 'n':
+        top_count = atoi(optarg);
+        break;
+      case 'i':
+        interval = atoi(optarg);
+        break;
+      default:
+        usage();
+        return 1;
+    }
+  }
+
+  // connect to the HAL
+  comp_id = hal_init(modname);
+  if (comp_id < 1) {
+    fprintf(stderr, "%s: ERROR: hal_init failed\n", modname);
+    goto fail0;
+  }
+
+  // try to get profiling header
+  shmem_id = rtapi_shmem_new(LCEC_PROFILE_SHMEM_KEY, comp_id, sizeof(lcec_profile_header_t));
+  if (shmem_id < 0) {
+    fprintf(stderr, "%s: ERROR: couldn't allocate user/RT shared memory\n", modname);
+    goto fail1;
+  }
+  if (lcec_rtapi_shmem_getptr(shmem_id, &shmem_ptr) < 0) {
+    fprintf(stderr, "%s: ERROR: couldn't map user/RT shared memory\n", modname);
+    goto fail2;
+  }
+
+  // check magic, get count and close shmem
+  header = shmem_ptr;
+  if (header->magic != LCEC_PROFILE_SHMEM_MAGIC) {
+    fprintf(stderr, "%s: ERROR: lcec is not loaded or no master has profileSlaves=\"true\"\n", modname);
+    goto fail2;
+  }
+  count = header->count;
+  rtapi_shmem_delete(shmem_id, comp_id);
+
+  // reopen shmem with proper size
+  shmem_id = rtapi_shmem_new(LCEC_PROFILE_SHMEM_KEY, comp_id, sizeof(lcec_profile_header_t) + count * sizeof(lcec_profile_record_t));
+  if (shmem_id < 0) {
+    fprintf(stderr, "%s: ERROR: couldn't allocate user/RT shared memory\n", modname);
+    goto fail1;
+  }
+  if (lcec_rtapi_shmem_getptr(shmem_id, &shmem_ptr) < 0) {
+    fprintf(stderr, "%s: ERROR: couldn't map user/RT shared memory\n", modname);
+    goto fail2;
+  }
+
+  records = calloc(count, sizeof(lcec_profile_record_t));
+  types = calloc(count, sizeof(type_summary_t));
+  if (records == NULL || types == NULL) {
+    fprintf(stderr, "%s: ERROR: unable to allocate memory\n", modname);
+    goto fail3;
+  }
+
+  signal(SIGINT, exitHandler);
+  signal(SIGTERM, exitHandler);
+
+  do {
+    snapshot(records, shmem_ptr + sizeof(lcec_profile_header_t), count);
+    if (interval > 0) {
+      printf("\033[H\033[2J");
+    }
+    print_report(records, count, types, top_count);
+    fflush(stdout);
+    if (interval > 0) {
+      sleep(interval);
+    }
+  } while (interval > 0 && !exit_flag);
+
+  ret = 0;
+
+fail3:
+  free(records);
+  free(types);
+fail2:
+  rtapi_shmem_delete(shmem_id, comp_id);
+fail1:
+  hal_exit(comp_id);
+fail0:
+  return ret;
+}
@@ -0,0 +1,56 @@
+//
+//    Copyright (C) 2024 The LinuxCNC-Ethercat authors
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+/// @file
+/// @brief Static tracepoints for the realtime cycle.
+///
+/// With `make LCEC_TRACE=1`, the tracepoints are compiled in as USDT
+/// probes of the provider `lcec`, which `perf`, `bpftrace` or LTTng can
+/// attach to.  A probe that is not attached costs a single `nop`.
+/// Otherwise, and always in kernel mode, the macros compile to nothing
+/// and their arguments are not evaluated.
+///
+/// Probes and their arguments:
+///
+/// - `read_begin`, `read_received`, `read_end`: master name.
+/// - `write_begin`, `write_send`, `write_end`: master name.
+/// - `slave_begin`, `slave_end`: master name, slave name, 1 for write.
+/// - `bus_cycle_begin`, `bus_cycle_end`: master name.
+/// - `sdo_read_begin`, `sdo_write_begin`: slave name, index, subindex.
+/// - `sdo_read_end`, `sdo_write_end`: slave name, index, subindex, result.
+
+#ifndef _LCEC_TRACE_H_
+#define _LCEC_TRACE_H_
+
+#if defined(LCEC_TRACE) && !defined(__KERNEL__)
+
+#include <sys/sdt.h>
+
+#define LCEC_TRACE1(name, a1)             DTRACE_PROBE1(lcec, name, a1)
+#define LCEC_TRACE3(name, a1, a2, a3)     DTRACE_PROBE3(lcec, name, a1, a2, a3)
+#define LCEC_TRACE4(name, a1, a2, a3, a4) DTRACE_PROBE4(lcec, name, a1, a2, a3, a4)
+
+#else
+
+#define LCEC_TRACE1(name, a1)             do {} while (0)
+#define LCEC_TRACE3(name, a1, a2, a3)     do {} while (0)
+#define LCEC_TRACE4(name, a1, a2, a3, a4) do {} while (0)
+
+#endif
+
+#endif
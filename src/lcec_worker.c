@@ -0,0 +1,434 @@
+//
+//    Copyright (C) 2024 The LinuxCNC-Ethercat authors
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+/// @file
+/// @brief Pinned realtime worker threads, for running parts of the cycle in parallel.
+///
+/// A worker runs one job per call to `lcec_worker_run()`.  The calling
+/// HAL thread continues with its own work and collects the worker with
+/// `lcec_worker_wait()`.  Both sides busy-wait, since sleeping and
+/// waking up takes longer than a typical job, so workers should be
+/// pinned to isolated CPUs.  After a job, a worker busy-waits for the
+/// next one for `LCEC_WORKER_SPIN_PERIODS` of the job's period, so it
+/// stays awake while the cycle runs.  Only when the calling thread stops
+/// does it sleep until woken by `lcec_worker_run()`.
+///
+/// A worker that may run on the CPU of the thread calling
+/// `lcec_worker_run()` could never run while that thread waits for it.
+/// This is checked on the first `lcec_worker_run()`; such a worker is
+/// not used, and its jobs run directly in the calling thread.
+///
+/// Workers are only available in userspace realtime.  In kernel mode
+/// `lcec_worker_start()` fails and `lcec_worker_run()` runs the job
+/// directly.
+///
+/// For startup work that blocks, like SDO transfers, there is a simple
+/// job queue: `lcec_jobs_start()` runs a number of jobs on ordinary,
+/// sleeping threads, and `lcec_jobs_wait()` helps out with the
+/// remaining jobs and collects the threads.  In kernel mode, or with
+/// a single thread, all jobs run in order in `lcec_jobs_wait()`.
+///
+/// Work that the realtime functions find out about but must not do
+/// themselves, like blocking calls into the EtherCAT master, goes to a
+/// deferred task: `lcec_deferred_trigger()` wakes an ordinary, sleeping
+/// thread that runs the task's function.  Deferred tasks are only
+/// available in userspace realtime.
+
+#ifndef __KERNEL__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // for CPU affinity
+#endif
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "lcec.h"
+
+struct lcec_jobs {
+  lcec_job_func_t func;  ///< Job function.
+  void *arg;             ///< Argument for `func`.
+  int count;             ///< Number of jobs.
+  int next;              ///< Index of the next job to run.
+  int failed;            ///< Number of failed jobs.
+#ifndef __KERNEL__
+  int thread_count;      ///< Number of threads started.
+  pthread_t *threads;    ///< Threads, besides the one calling `lcec_jobs_wait()`.
+#endif
+};
+
+/// @brief Run jobs of a queue until there are none left.
+static void *lcec_jobs_main(void *arg) {
+  lcec_jobs_t *jobs = arg;
+  int index;
+
+  while ((index = __atomic_fetch_add(&jobs->next, 1, __ATOMIC_RELAXED)) < jobs->count) {
+    if (jobs->func(jobs->arg, index) != 0) {
+      __atomic_fetch_add(&jobs->failed, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  return NULL;
+}
+
+/// @brief Start a job queue.
+/// @param name Name of the queue, for messages.
+/// @param threads Number of jobs to run at the same time, including the thread calling `lcec_jobs_wait()`.
+/// @param func Job function, called with `arg` and the job index.  Returns non-zero on failure.
+/// @param arg Argument for `func`.
+/// @param count Number of jobs.
+/// @return The queue, or NULL on error.
+lcec_jobs_t *lcec_jobs_start(const char *name, int threads, lcec_job_func_t func, void *arg, int count) {
+  lcec_jobs_t *jobs;
+
+  jobs = lcec_zalloc(sizeof(lcec_jobs_t));
+  if (jobs == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate job queue %s memory\n", name);
+    return NULL;
+  }
+  jobs->func = func;
+  jobs->arg = arg;
+  jobs->count = count;
+
+#ifndef __KERNEL__
+  // no point in more threads than jobs
+  if (threads > count) {
+    threads = count;
+  }
+  if (threads > 1) {
+    jobs->threads = lcec_zalloc(sizeof(pthread_t) * (threads - 1));
+    if (jobs->threads == NULL) {
+      rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "job queue %s: unable to allocate thread memory, running jobs in sequence\n", name);
+      return jobs;
+    }
+    for (; jobs->thread_count < threads - 1; jobs->thread_count++) {
+      if (pthread_create(&jobs->threads[jobs->thread_count], NULL, lcec_jobs_main, jobs) != 0) {
+        rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "job queue %s: unable to create thread, running %d jobs at a time\n", name,
+            jobs->thread_count + 1);
+        break;
+      }
+    }
+  }
+#endif
+
+  return jobs;
+}
+
+/// @brief Wait until all jobs of a queue are done, and free the queue.
+/// @return The number of failed jobs.
+int lcec_jobs_wait(lcec_jobs_t *jobs) {
+  int failed;
+
+  lcec_jobs_main(jobs);
+
+#ifndef __KERNEL__
+  for (int i = 0; i < jobs->thread_count; i++) {
+    pthread_join(jobs->threads[i], NULL);
+  }
+  if (jobs->threads != NULL) {
+    lcec_free(jobs->threads);
+  }
+#endif
+
+  failed = jobs->failed;
+  lcec_free(jobs);
+  return failed;
+}
+
+#ifndef __KERNEL__
+
+#if defined(__i386__) || defined(__x86_64__)
+#define LCEC_CPU_RELAX() __builtin_ia32_pause()
+#else
+#define LCEC_CPU_RELAX() __sync_synchronize()
+#endif
+
+/// @brief Sleep while `*addr` is `val`.  May return early.
+static void lcec_futex_wait(unsigned int *addr, unsigned int val) { syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0); }
+
+/// @brief Wake all threads sleeping on `addr`.
+static void lcec_futex_wake(unsigned int *addr) { syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0); }
+
+struct lcec_deferred {
+  pthread_t thread;           ///< Thread running the task.
+  lcec_deferred_func_t func;  ///< Task function.
+  void *arg;                  ///< Argument for `func`.
+  unsigned int seq;           ///< Incremented for each trigger.
+  int stop;                   ///< Ask the thread to exit.
+};
+
+static void *lcec_deferred_main(void *arg) {
+  lcec_deferred_t *deferred = arg;
+  unsigned int seq = 0, next;
+
+  while (1) {
+    // sleep until triggered, triggers that come in while the task runs are merged
+    while ((next = __atomic_load_n(&deferred->seq, __ATOMIC_ACQUIRE)) == seq) {
+      lcec_futex_wait(&deferred->seq, seq);
+    }
+    seq = next;
+
+    if (deferred->stop) {
+      break;
+    }
+
+    deferred->func(deferred->arg);
+  }
+
+  return NULL;
+}
+
+/// @brief Start a deferred task, running on an ordinary thread.
+/// @param name Name of the task, for messages.
+/// @param func Task function, called with `arg` after each trigger.
+/// @param arg Argument for `func`.
+/// @return The task, or NULL on error.
+lcec_deferred_t *lcec_deferred_start(const char *name, lcec_deferred_func_t func, void *arg) {
+  lcec_deferred_t *deferred;
+  int err;
+
+  deferred = lcec_zalloc(sizeof(lcec_deferred_t));
+  if (deferred == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate deferred task %s memory\n", name);
+    return NULL;
+  }
+  deferred->func = func;
+  deferred->arg = arg;
+
+  err = pthread_create(&deferred->thread, NULL, lcec_deferred_main, deferred);
+  if (err != 0) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "deferred task %s: unable to create thread (error %d)\n", name, err);
+    lcec_free(deferred);
+    return NULL;
+  }
+
+  return deferred;
+}
+
+/// @brief Run a deferred task's function soon.  Doesn't block, so it may be called from realtime functions.
+void lcec_deferred_trigger(lcec_deferred_t *deferred) {
+  __atomic_fetch_add(&deferred->seq, 1, __ATOMIC_RELEASE);
+  lcec_futex_wake(&deferred->seq);
+}
+
+/// @brief Stop a deferred task and free it.  A task function that is running is finished first.
+void lcec_deferred_stop(lcec_deferred_t *deferred) {
+  deferred->stop = 1;
+  lcec_deferred_trigger(deferred);
+  pthread_join(deferred->thread, NULL);
+  lcec_free(deferred);
+}
+
+// periods a worker busy-waits for the next job before it sleeps, one period plus margin
+#define LCEC_WORKER_SPIN_PERIODS 2
+// minimal busy-wait time, in ns, used before the first job too
+#define LCEC_WORKER_SPIN_MIN 100000
+
+struct lcec_worker {
+  pthread_t thread;                 ///< Worker thread.
+  char name[LCEC_CONF_STR_MAXLEN];  ///< Name, for messages.
+  uint64_t cpu_mask;                ///< CPUs the worker may run on, 0 for all.
+  lcec_worker_func_t func;          ///< Current job.
+  void *arg;                        ///< Argument for `func`.
+  long period;                      ///< Period for `func`.
+  unsigned int start_seq;           ///< Incremented by the caller to start a job.
+  unsigned int done_seq;            ///< Set to `start_seq` by the worker when the job is done.
+  int sleeping;                     ///< Is the worker about to sleep or sleeping on `start_seq`?
+  int checked;                      ///< Was the CPU of the calling thread checked?
+  int direct;                       ///< Run jobs in the calling thread, the worker shares its CPU.
+  int stop;                         ///< Ask the worker to exit.
+};
+
+/// @brief Wait until `start_seq` moves on from `seq`: busy-wait for a while, then sleep.
+///
+/// The busy-wait lasts longer than the period of the last job, so a
+/// worker of a running cycle never sleeps and `lcec_worker_run()` never
+/// needs a syscall to wake it.
+static void lcec_worker_wait_job(lcec_worker_t *worker, unsigned int seq) {
+  long long spin = (long long)worker->period * LCEC_WORKER_SPIN_PERIODS;
+  long long deadline = rtapi_get_time() + ((spin > LCEC_WORKER_SPIN_MIN) ? spin : LCEC_WORKER_SPIN_MIN);
+
+  while (__atomic_load_n(&worker->start_seq, __ATOMIC_ACQUIRE) == seq) {
+    if (rtapi_get_time() < deadline) {
+      LCEC_CPU_RELAX();
+      continue;
+    }
+
+    // announce the sleep before checking again, so lcec_worker_run() either sees it or we see the new job
+    __atomic_store_n(&worker->sleeping, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&worker->start_seq, __ATOMIC_SEQ_CST) == seq) {
+      lcec_futex_wait(&worker->start_seq, seq);
+    }
+    __atomic_store_n(&worker->sleeping, 0, __ATOMIC_RELAXED);
+  }
+}
+
+static void *lcec_worker_main(void *arg) {
+  lcec_worker_t *worker = arg;
+  unsigned int seq = 0;
+
+  while (1) {
+    // wait for the next job
+    lcec_worker_wait_job(worker, seq);
+    seq++;
+
+    if (worker->stop) {
+      break;
+    }
+
+    worker->func(worker->arg, worker->period);
+    __atomic_store_n(&worker->done_seq, seq, __ATOMIC_RELEASE);
+  }
+
+  return NULL;
+}
+
+/// @brief Start a worker thread.
+/// @param name Name of the worker, for messages.
+/// @param cpu_mask CPUs the worker may run on, bit n for CPU n.  0 to not pin the worker.
+/// @return The worker, or NULL on error.
+lcec_worker_t *lcec_worker_start(const char *name, uint64_t cpu_mask) {
+  lcec_worker_t *worker;
+  pthread_attr_t attr;
+  struct sched_param param;
+  cpu_set_t cpus;
+  int cpu, err;
+
+  worker = lcec_zalloc(sizeof(lcec_worker_t));
+  if (worker == NULL) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "Unable to allocate worker %s memory\n", name);
+    return NULL;
+  }
+  strncpy(worker->name, name, LCEC_CONF_STR_MAXLEN - 1);
+  worker->cpu_mask = cpu_mask;
+
+  // run with realtime priority, on the configured CPUs
+  pthread_attr_init(&attr);
+  pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+  pthread_attr_setschedparam(&attr, &param);
+  if (cpu_mask != 0) {
+    CPU_ZERO(&cpus);
+    for (cpu = 0; cpu < 64; cpu++) {
+      if (cpu_mask & (1ULL << cpu)) {
+        CPU_SET(cpu, &cpus);
+      }
+    }
+    pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+  }
+
+  err = pthread_create(&worker->thread, &attr, lcec_worker_main, worker);
+  if (err == EPERM) {
+    // not allowed to use realtime scheduling, run without it
+    rtapi_print_msg(RTAPI_MSG_WARN, LCEC_MSG_PFX "worker %s: unable to set realtime priority, cycles will be slower\n", name);
+    pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+    err = pthread_create(&worker->thread, &attr, lcec_worker_main, worker);
+  }
+  pthread_attr_destroy(&attr);
+  if (err != 0) {
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "worker %s: unable to create thread (error %d)\n", name, err);
+    lcec_free(worker);
+    return NULL;
+  }
+
+  return worker;
+}
+
+/// @brief Check once that the worker can't run on the CPU of the calling thread.
+///
+/// The calling thread busy-waits for the worker, so a worker on the same
+/// CPU would never get to run.  Such a worker is not used.
+static void lcec_worker_check_cpu(lcec_worker_t *worker) {
+  int cpu = sched_getcpu();
+
+  worker->checked = 1;
+  if (cpu >= 0 && cpu < 64 && (worker->cpu_mask & (1ULL << cpu))) {
+    worker->direct = 1;
+    rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "worker %s: may run on CPU %d of the calling thread, running its jobs there instead\n",
+        worker->name, cpu);
+  }
+}
+
+/// @brief Start a job on a worker.
+///
+/// The previous job must have been collected with `lcec_worker_wait()`.
+void lcec_worker_run(lcec_worker_t *worker, lcec_worker_func_t func, void *arg, long period) {
+  if (!worker->checked) {
+    lcec_worker_check_cpu(worker);
+  }
+  if (worker->direct) {
+    func(arg, period);
+    return;
+  }
+
+  worker->func = func;
+  worker->arg = arg;
+  worker->period = period;
+  __atomic_store_n(&worker->start_seq, worker->start_seq + 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&worker->sleeping, __ATOMIC_SEQ_CST)) {
+    lcec_futex_wake(&worker->start_seq);
+  }
+}
+
+/// @brief Wait until a worker has finished its current job.
+void lcec_worker_wait(lcec_worker_t *worker) {
+  if (worker->direct) {
+    return;
+  }
+  while (__atomic_load_n(&worker->done_seq, __ATOMIC_ACQUIRE) != worker->start_seq) {
+    LCEC_CPU_RELAX();
+  }
+}
+
+/// @brief Stop a worker thread and free it.
+void lcec_worker_stop(lcec_worker_t *worker) {
+  worker->stop = 1;
+  __atomic_store_n(&worker->start_seq, worker->start_seq + 1, __ATOMIC_SEQ_CST);
+  lcec_futex_wake(&worker->start_seq);
+  pthread_join(worker->thread, NULL);
+  lcec_free(worker);
+}
+
+#else
+
+lcec_worker_t *lcec_worker_start(const char *name, uint64_t cpu_mask) {
+  rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "worker %s: worker threads are not supported in kernel mode\n", name);
+  return NULL;
+}
+
+void lcec_worker_run(lcec_worker_t *worker, lcec_worker_func_t func, void *arg, long period) { func(arg, period); }
+
+void lcec_worker_wait(lcec_worker_t *worker) {}
+
+void lcec_worker_stop(lcec_worker_t *worker) {}
+
+lcec_deferred_t *lcec_deferred_start(const char *name, lcec_deferred_func_t func, void *arg) {
+  rtapi_print_msg(RTAPI_MSG_ERR, LCEC_MSG_PFX "deferred task %s: not supported in kernel mode\n", name);
+  return NULL;
+}
+
+void lcec_deferred_trigger(lcec_deferred_t *deferred) {}
+
+void lcec_deferred_stop(lcec_deferred_t *deferred) {}
+
+#endif
@@ -0,0 +1,65 @@
+#include <stdio.h>
+
+#include "../../src/lcec.h"
+#include "tests.h"
+
+TESTGLOBALSETUP;
+
+static lcec_typelist_t types1[] = {
+    {"TEST1000", 0x1234, 0x1000, 1},
+    {"TEST2000", 0x1234, 0x2000, 2},
+    {"TEST2000-ALIAS", 0x1234, 0x2000, 3},  // same vid/pid as TEST2000
+    {NULL},
+};
+
+static lcec_typelist_t types2[] = {
+    {"TEST1000", 0x1234, 0x3000, 4},  // duplicate name, ignored
+    {"TEST3000", 0x5678, 0x1000, 5},
+    {NULL},
+};
+
+// Test functions run as constructors in no particular order, so each registers the types on demand.
+static void register_types(void) {
+  static int registered = 0;
+
+  if (!registered) {
+    lcec_addtypes(types1, __FILE__);
+    lcec_addtypes(types2, __FILE__);
+    registered = 1;
+  }
+}
+
+TESTFUNC(test_findslavetype) {
+  TESTSETUP;
+
+  register_types();
+
+  // Types are found by name.
+  TESTINT(lcec_findslavetype("TEST1000") != NULL, 1);
+  TESTINT(lcec_findslavetype("TEST1000")->pdo_entry_count, 1);
+  TESTINT(lcec_findslavetype("TEST2000-ALIAS")->pdo_entry_count, 3);
+  TESTINT(lcec_findslavetype("TEST3000")->pdo_entry_count, 5);
+  // Names are case sensitive, and unknown names return NULL.
+  TESTINT(lcec_findslavetype("test1000") == NULL, 1);
+  TESTINT(lcec_findslavetype("TEST4000") == NULL, 1);
+
+  TESTRESULTS;
+}
+
+TESTFUNC(test_findslavetype_id) {
+  TESTSETUP;
+
+  register_types();
+
+  // Types are found by vendor and product ID.
+  TESTINT(lcec_findslavetype_id(0x1234, 0x1000)->pdo_entry_count, 1);
+  TESTINT(lcec_findslavetype_id(0x5678, 0x1000)->pdo_entry_count, 5);
+  // The first type registered wins if several share an ID.
+  TESTINT(lcec_findslavetype_id(0x1234, 0x2000)->pdo_entry_count, 2);
+  // The duplicate TEST1000 wasn't registered.
+  TESTINT(lcec_findslavetype_id(0x1234, 0x3000) == NULL, 1);
+
+  TESTRESULTS;
+}
+
+TESTMAIN